@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <iterator>
+
+#include "glog/logging.h"
+
+namespace compact {
+namespace lib {
+
+/*
+  Base of the forward cursors of the compact arrays. A cursor keeps whatever
+  decoding state its array needs between consecutive elements, so a full scan
+  pays neither the virtual read() nor relocating the element on every step.
+
+  Derived cursors provide operator*(), the prefix operator++() (bringing the
+  postfix one in with a using declaration) and index(), the position they
+  point to; two cursors are equal if they point to the same position.
+  Cursors are invalidated by any change to their array.
+*/
+template <typename Derived>
+class ArrayCursor {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = uint;
+  using difference_type = ptrdiff_t;
+  using pointer = const uint*;
+  using reference = uint;
+
+  Derived operator++(int) {
+    Derived old = derived();
+    ++derived();
+    return old;
+  }
+
+  bool operator==(const Derived& other) const {
+    return derived().index() == other.index();
+  }
+
+  bool operator!=(const Derived& other) const { return !(*this == other); }
+
+ private:
+  Derived& derived() { return static_cast<Derived&>(*this); }
+
+  const Derived& derived() const { return static_cast<const Derived&>(*this); }
+};
+
+}  // namespace lib
+}  // namespace compact
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <math.h>
+#include <stdint.h>
 
 #include <utility>
 #include <vector>
@@ -12,18 +13,29 @@
 namespace compact {
 namespace lib {
 
-class BitArray : public Array {
+/*
+  Plain bit stream stored on cells of type WordType. Use BitArray for 32-bit
+  cells and BitArray64 for 64-bit cells.
+*/
+template <typename WordType = uint>
+class BasicBitArray : public Array {
  public:
-  BitArray() : array() {}
+  using Word = WordType;
+  using Storage = BasicFixedSizeArray<WordType>;
 
-  BitArray(uint n) { resize(n); }
+  // size of a storage cell, measured in bits
+  static constexpr uint kCellSize = Storage::kCellSize;
 
-  BitArray(const std::vector<uint>& values) { reset(values); }
+  BasicBitArray() : array() {}
 
-  BitArray(const std::initializer_list<uint>& values)
-      : BitArray(std::vector<uint>(values)) {}
+  BasicBitArray(uint n) { resize(n); }
 
-  ~BitArray() {}
+  BasicBitArray(const std::vector<uint>& values) { reset(values); }
+
+  BasicBitArray(const std::initializer_list<uint>& values)
+      : BasicBitArray(std::vector<uint>(values)) {}
+
+  ~BasicBitArray() {}
 
   uint size() const override { return array.size(); }
 
@@ -38,22 +50,42 @@ class BitArray : public Array {
 
   uint read(uint idx) const override { return array.read(idx); }
 
+  using Cursor = typename Storage::Cursor;
+
+  Cursor begin() const { return array.begin(); }
+
+  Cursor end() const { return array.end(); }
+
+  // cursor pointing to position idx
+  Cursor cursor(uint idx) const { return array.cursor(idx); }
+
   void write(uint idx, uint val) override { array.write(idx, val); }
 
-  uint read_interval(uint startBit, uint endBit) const {
-    uint start_word = startBit / BitmaskUtility::kWordSize;
-    uint end_word = endBit / BitmaskUtility::kWordSize;
+  // read bits [startBit, endBit] (at most kCellSize of them), LSB first
+  WordType read_interval(uint startBit, uint endBit) const {
+    uint start_word = startBit / kCellSize;
+    uint end_word = endBit / kCellSize;
     if (start_word == end_word) {
       return array.read_bit_interval(startBit, endBit);
     }
-    uint end_start_word = end_word * BitmaskUtility::kWordSize - 1;
+    uint end_start_word = end_word * kCellSize - 1;
 
-    uint left_part = array.read_bit_interval(startBit, end_start_word);
-    uint right_part = array.read_bit_interval(end_start_word + 1, endBit);
+    WordType left_part = array.read_bit_interval(startBit, end_start_word);
+    WordType right_part = array.read_bit_interval(end_start_word + 1, endBit);
     return left_part | (right_part << (end_start_word - startBit + 1));
   }
 
-  // TODO: add write_interval
+  // number of storage cells used by the bit array
+  uint cell_count() const { return array.cell_count(); }
+
+  /*
+    raw access to a whole storage cell, bit i of the array being bit
+    i % kCellSize of cell i / kCellSize. No bounds checking, meant for bulk
+    readers and writers such as BitReader and BitWriter
+  */
+  WordType read_cell(uint idx) const { return array.read_cell(idx); }
+
+  void write_cell(uint idx, WordType val) { array.write_cell(idx, val); }
 
   std::string to_string() const { return array.to_string(); }
 
@@ -61,8 +93,11 @@ class BitArray : public Array {
   uint measure_memory() const override { return array.measure_memory(); }
 
  private:
-  FixedSizeArray array;
+  Storage array;
 };
 
+using BitArray = BasicBitArray<uint>;
+using BitArray64 = BasicBitArray<uint64_t>;
+
 }  // namespace lib
 }  // namespace compact
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+
+#include "glog/logging.h"
+#include "lib/BitArray.h"
+#include "lib/utils/BitmaskUtility.h"
+
+namespace compact {
+namespace lib {
+
+/*
+  Sequential writer of multi-bit codes over a bit array.
+
+  Codes are appended LSB first (bit i of the code goes to position + i) into a
+  local buffer, and the bit array is only touched once per storage cell. The
+  bits before the starting position are kept, and the last partial cell is
+  merged with the bits after the end of the written stream on flush(), which
+  is also called by the destructor.
+
+  Use BitWriter for BitArray and BitWriter64 for BitArray64.
+*/
+template <typename BitArrayType = BitArray>
+class BasicBitWriter {
+ public:
+  using Word = typename BitArrayType::Word;
+  using Mask = WordBitmaskUtility<Word>;
+
+  // size of a storage cell, measured in bits
+  static constexpr uint kCellSize = BitArrayType::kCellSize;
+  // maximum length of a single code, measured in bits
+  static constexpr uint kMaxCodeLength = WordBitmaskUtility<uint>::kWordSize;
+
+  BasicBitWriter(BitArrayType& bits, uint pos = 0)
+      : bits(bits), cell(pos / kCellSize), used(pos % kCellSize), buffer(0) {
+    if (pos > bits.size()) {
+      throw std::runtime_error("Invalid starting position " +
+                               std::to_string(pos) + "! Bit array size is: " +
+                               std::to_string(bits.size()));
+    }
+    if (used) buffer = bits.read_cell(cell) & Mask::get_full_ones(used);
+  }
+
+  ~BasicBitWriter() { flush(); }
+
+  BasicBitWriter(const BasicBitWriter&) = delete;
+  BasicBitWriter& operator=(const BasicBitWriter&) = delete;
+
+  // position of the next bit to be written
+  uint position() const { return cell * kCellSize + used; }
+
+  // append the len (at most kMaxCodeLength) least significant bits of code
+  void write(uint code, uint len) {
+    if (!len) return;
+    if (len > kMaxCodeLength || uint64_t(position()) + len > bits.size()) {
+      throw std::runtime_error(
+          "Write failed! Code of length " + std::to_string(len) +
+          " at position " + std::to_string(position()) +
+          " does not fit! Bit array size is: " + std::to_string(bits.size()));
+    }
+    uint64_t value = code & BitmaskUtility::get_full_ones(len);
+    buffer |= value << used;
+    if (used + len < kCellSize) {
+      used += len;
+      return;
+    }
+    // the current cell is complete
+    uint written = kCellSize - used;
+    bits.write_cell(cell++, Word(buffer));
+    buffer = written < 64 ? value >> written : 0;
+    used = used + len - kCellSize;
+  }
+
+  void write_bit(uint bit) { write(bit & 1, 1); }
+
+  // append the len least significant bits of code, most significant first
+  void write_reversed(uint code, uint len) {
+    write(reverse_bits(code, len), len);
+  }
+
+  // append len zeros
+  void write_zeros(uint len) {
+    for (; len > kMaxCodeLength; len -= kMaxCodeLength) {
+      write(0, kMaxCodeLength);
+    }
+    write(0, len);
+  }
+
+  // write the partial cell on the bit array, keeping the bits after it
+  void flush() {
+    if (!used) return;
+    Word high_bits = bits.read_cell(cell) & ~Mask::get_full_ones(used);
+    bits.write_cell(cell, high_bits | Word(buffer));
+  }
+
+  // reverse the order of the len least significant bits of code
+  static uint reverse_bits(uint code, uint len) {
+    if (!len) return 0;
+    code = ((code >> 1) & 0x55555555) | ((code & 0x55555555) << 1);
+    code = ((code >> 2) & 0x33333333) | ((code & 0x33333333) << 2);
+    code = ((code >> 4) & 0x0F0F0F0F) | ((code & 0x0F0F0F0F) << 4);
+    code = __builtin_bswap32(code);
+    return code >> (kMaxCodeLength - len);
+  }
+
+ private:
+  BitArrayType& bits;
+  // storage cell being filled, and number of bits of it on the buffer
+  uint cell;
+  uint used;
+  uint64_t buffer;
+};
+
+/*
+  Sequential reader of multi-bit codes over a bit array.
+
+  Keeps up to 64 bits of the stream, starting at the current position, on a
+  local buffer that is refilled a storage cell at a time, so peeking or
+  consuming a code is a couple of shifts. Bits after the end of the array are
+  read as zeros; callers are expected to stop at the size of the array.
+  Readers are cheap to copy, each copy going on from the same position.
+
+  Use BitReader for BitArray and BitReader64 for BitArray64.
+*/
+template <typename BitArrayType = BitArray>
+class BasicBitReader {
+ public:
+  using Word = typename BitArrayType::Word;
+  using Mask = WordBitmaskUtility<Word>;
+
+  // size of a storage cell, measured in bits
+  static constexpr uint kCellSize = BitArrayType::kCellSize;
+  // maximum length of a single code, measured in bits
+  static constexpr uint kMaxCodeLength = WordBitmaskUtility<uint>::kWordSize;
+
+  BasicBitReader() : bits(NULL), next(0), available(0), buffer(0) {}
+
+  BasicBitReader(const BitArrayType& bits, uint pos = 0)
+      : bits(&bits), next(pos), available(0), buffer(0) {
+    if (pos > bits.size()) {
+      throw std::runtime_error("Invalid starting position " +
+                               std::to_string(pos) + "! Bit array size is: " +
+                               std::to_string(bits.size()));
+    }
+    refill();
+  }
+
+  // position of the next bit to be read
+  uint position() const { return next - available; }
+
+  // size of the underlying bit array
+  uint size() const { return bits->size(); }
+
+  bool empty() const { return position() >= bits->size(); }
+
+  // next len (at most kMaxCodeLength) bits, LSB first, without consuming them
+  uint peek(uint len) {
+    if (available < len) refill();
+    return buffer & BitmaskUtility::get_full_ones(len);
+  }
+
+  // consume the next len (at most kMaxCodeLength) bits, LSB first
+  uint read(uint len) {
+    uint code = peek(len);
+    skip(len);
+    return code;
+  }
+
+  uint read_bit() { return read(1); }
+
+  // consume the next len bits, most significant first
+  uint read_reversed(uint len) {
+    return BasicBitWriter<BitArrayType>::reverse_bits(read(len), len);
+  }
+
+  // number of zeros before the next one, 64 at most; they are not consumed
+  uint count_zeros() {
+    if (available < 64) refill();
+    return buffer ? __builtin_ctzll(buffer) : 64;
+  }
+
+  void skip(uint len) {
+    while (len) {
+      if (!available) refill();
+      if (!available) {
+        // past the end of the array
+        next += len;
+        return;
+      }
+      uint step = std::min(len, available);
+      buffer = step < 64 ? buffer >> step : 0;
+      available -= step;
+      len -= step;
+    }
+  }
+
+ private:
+  const BitArrayType* bits;
+  // position of the first bit not yet on the buffer
+  uint next;
+  // number of valid bits on the buffer
+  uint available;
+  uint64_t buffer;
+
+  void refill() {
+    while (available < 64 && next < bits->size()) {
+      uint offset = next % kCellSize;
+      uint take = std::min(kCellSize - offset, 64 - available);
+      uint64_t word = bits->read_cell(next / kCellSize) >> offset;
+      if (take < 64) word &= (uint64_t(1) << take) - 1;
+      buffer |= word << available;
+      available += take;
+      next += take;
+    }
+  }
+};
+
+using BitWriter = BasicBitWriter<BitArray>;
+using BitWriter64 = BasicBitWriter<BitArray64>;
+using BitReader = BasicBitReader<BitArray>;
+using BitReader64 = BasicBitReader<BitArray64>;
+
+}  // namespace lib
+}  // namespace compact
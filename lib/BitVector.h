@@ -2,36 +2,90 @@
 
 #include <math.h>
 
+#include <atomic>
+#include <mutex>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "glog/logging.h"
 #include "lib/Array.h"
 #include "lib/BitArray.h"
 #include "lib/ClarkSelect.h"
+#include "lib/InterleavedRank.h"
 #include "lib/JacobsonRank.h"
+#include "lib/RRRBitVector.h"
+#include "lib/SampledSelect.h"
 
 namespace compact {
 namespace lib {
 
-class BitVector : public Array {
+// how a BasicBitVector answers select queries
+enum SelectSupport {
+  // select structures built along with the rank directory
+  kEagerSelect,
+  // the select structure of each bit value is built on its first query
+  kLazySelect,
+  // no select structures, binary search over the rank directory
+  kNoSelect
+};
+
+/*
+  Bit stream with rank and select support. Use BitVector for the 32-bit cell
+  storage and BitVector64 for the 64-bit one, which keeps the rank counters
+  interleaved with the bits and samples select over them.
+
+  The rank directory is always built, the select structures depend on the
+  SelectSupport given on construction. Lazy builds are thread-safe, so
+  concurrent queries may share a bitvector.
+*/
+template <typename BitArrayType = BitArray,
+          typename RankType = JacobsonRank<BitArrayType>,
+          typename SelectType = ClarkSelect<BitArrayType>>
+class BasicBitVector : public Array {
  public:
-  BitVector()
+  BasicBitVector(SelectSupport select_support = kLazySelect)
       : bit_stream(),
         rank_manager(bit_stream),
-        select_manager({ClarkSelect<BitArray>(bit_stream, 0),
-                        ClarkSelect<BitArray>(bit_stream)}) {}
+        select_manager({SelectType(bit_stream, 0), SelectType(bit_stream)}),
+        select_support(select_support),
+        select_built{false, false} {}
 
-  BitVector(uint n) : BitVector() { resize(n); }
+  BasicBitVector(uint n, SelectSupport select_support = kLazySelect)
+      : BasicBitVector(select_support) {
+    resize(n);
+  }
 
-  BitVector(const Array& values) : BitVector() { reset(values); }
+  BasicBitVector(const Array& values,
+                 SelectSupport select_support = kLazySelect)
+      : BasicBitVector(select_support) {
+    reset(values);
+  }
 
-  BitVector(const std::vector<uint>& values) : BitVector() { reset(values); }
+  BasicBitVector(const std::vector<uint>& values,
+                 SelectSupport select_support = kLazySelect)
+      : BasicBitVector(select_support) {
+    reset(values);
+  }
 
-  BitVector(const std::initializer_list<uint>& values)
-      : BitVector(std::vector<uint>(values)) {}
+  BasicBitVector(const std::initializer_list<uint>& values)
+      : BasicBitVector(std::vector<uint>(values)) {}
 
-  ~BitVector() {}
+  // the rank and select structures point to bit_stream, so they are rebuilt
+  BasicBitVector(const BasicBitVector& other)
+      : BasicBitVector(other.select_support) {
+    *this = other;
+  }
+
+  BasicBitVector& operator=(const BasicBitVector& other) {
+    if (this == &other) return *this;
+    bit_stream = other.bit_stream;
+    select_support = other.select_support;
+    build();
+    return *this;
+  }
+
+  ~BasicBitVector() {}
 
   void resize(uint n) { assign(n, 0); }
 
@@ -65,32 +119,158 @@ class BitVector : public Array {
 
   uint select(uint idx, uint bit_value = 1) const {
     bit_value %= 2;
+    if (select_support == kNoSelect) return select_by_rank(idx, bit_value);
+    if (!select_built[bit_value].load(std::memory_order_acquire)) {
+      build_select(bit_value);
+    }
     return select_manager[bit_value].select(idx);
   }
 
+  SelectSupport get_select_support() const { return select_support; }
+
   std::string to_string() const { return bit_stream.to_string(); }
 
-  // measure memory used in bytes
+  // measure memory used in bytes, select structures only once built
   uint measure_memory() const override {
     uint rank = rank_manager.measure_memory();
-    uint select =
-        select_manager[0].measure_memory() + select_manager[1].measure_memory();
+    uint select = sizeof(select_support) + sizeof(select_built);
+    for (uint b = 0; b < 2; b++) {
+      if (select_built[b].load(std::memory_order_acquire)) {
+        select += select_manager[b].measure_memory();
+      }
+    }
     // LOG(INFO) << "memory - rank: " << rank << ", select: " << select
     //           << ", bit_stream: " << bit_stream.measure_memory();
     return bit_stream.measure_memory() + rank + select;
   }
 
  private:
-  BitArray bit_stream;
-  JacobsonRank<BitArray> rank_manager;
-  ClarkSelect<BitArray> select_manager[2];
+  BitArrayType bit_stream;
+  RankType rank_manager;
+  // built on first use, unless eager
+  mutable SelectType select_manager[2];
+  SelectSupport select_support;
+  mutable std::atomic<bool> select_built[2];
 
   void build() {
     rank_manager.build();
-    select_manager[0].build();
-    select_manager[1].build();
+    for (uint b = 0; b < 2; b++) {
+      select_built[b].store(false, std::memory_order_relaxed);
+      if (select_support == kEagerSelect) build_select(b);
+    }
+  }
+
+  void build_select(uint bit_value) const {
+    // lazy builds are rare, a single lock for all bitvectors is enough
+    static std::mutex build_mutex;
+    std::lock_guard<std::mutex> lock(build_mutex);
+    if (select_built[bit_value].load(std::memory_order_relaxed)) return;
+    select_manager[bit_value].build();
+    select_built[bit_value].store(true, std::memory_order_release);
+  }
+
+  // first position with idx+1 bits equal to bit_value up to it, or size()
+  uint select_by_rank(uint idx, uint bit_value) const {
+    uint n = size();
+    if (idx >= rank(n, bit_value)) return n;
+    uint low = 0, high = n - 1;
+    while (low < high) {
+      uint mid = low + (high - low) / 2;
+      if (rank(mid + 1, bit_value) > idx) {
+        high = mid;
+      } else {
+        low = mid + 1;
+      }
+    }
+    return low;
+  }
+};
+
+using BitVector = BasicBitVector<BitArray>;
+using BitVector64 =
+    BasicBitVector<InterleavedBitArray, InterleavedRank, SampledSelect>;
+
+/*
+  Bitvector choosing its representation by density when built: bit streams
+  with at most kMaxCompressedDensity of ones (or of zeros) are stored as an
+  RRRBitVector, the others as a PlainType bitvector. Meant for the structures
+  holding many bitvectors of varying density, such as the wavelet trees.
+*/
+template <typename PlainType = BitVector>
+class BasicAdaptiveBitVector : public Array {
+ public:
+  // fraction of the less frequent bit up to which the bits are compressed
+  static constexpr double kMaxCompressedDensity = 0.125;
+
+  BasicAdaptiveBitVector() : bits() {}
+
+  BasicAdaptiveBitVector(uint n) : BasicAdaptiveBitVector() { resize(n); }
+
+  BasicAdaptiveBitVector(const std::vector<uint>& values)
+      : BasicAdaptiveBitVector() {
+    reset(values);
+  }
+
+  BasicAdaptiveBitVector(const std::initializer_list<uint>& values)
+      : BasicAdaptiveBitVector(std::vector<uint>(values)) {}
+
+  void resize(uint n) { assign(n, 0); }
+
+  template <typename ArrayType>
+  void reset(const ArrayType& values) {
+    uint n = values.size(), ones = 0;
+    for (uint i = 0; i < n; i++) ones += values[i] & 1;
+    if (std::min(ones, n - ones) <= kMaxCompressedDensity * n) {
+      bits.template emplace<RRRBitVector>().reset(values);
+    } else {
+      bits.template emplace<PlainType>().reset(values);
+    }
+  }
+
+  void assign(uint n, uint val) { reset(std::vector<uint>(n, val)); }
+
+  // whether the bits are stored as an RRRBitVector
+  bool is_compressed() const {
+    return std::holds_alternative<RRRBitVector>(bits);
+  }
+
+  uint size() const override {
+    return std::visit([](const auto& b) { return b.size(); }, bits);
   }
+
+  uint read(uint idx) const override {
+    return std::visit([idx](const auto& b) { return b.read(idx); }, bits);
+  }
+
+  void write(uint idx, uint val) override {
+    throw std::runtime_error("BitVector is a read-only array!");
+  }
+
+  uint rank(uint pos, uint bit_value = 1) const {
+    return std::visit(
+        [=](const auto& b) { return b.rank(pos, bit_value); }, bits);
+  }
+
+  uint select(uint idx, uint bit_value = 1) const {
+    return std::visit(
+        [=](const auto& b) { return b.select(idx, bit_value); }, bits);
+  }
+
+  std::string to_string() const {
+    return std::visit([](const auto& b) { return b.to_string(); }, bits);
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const override {
+    return std::visit([](const auto& b) { return b.measure_memory(); }, bits);
+  }
+
+ private:
+  std::variant<RRRBitVector, PlainType> bits;
 };
 
+using AdaptiveBitVector = BasicAdaptiveBitVector<BitVector>;
+using AdaptiveBitVector64 = BasicAdaptiveBitVector<BitVector64>;
+
 }  // namespace lib
 }  // namespace compact
@@ -4,10 +4,12 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "glog/logging.h"
 #include "lib/Array.h"
 #include "lib/BitArray.h"
+#include "lib/FixedWidthArray.h"
 #include "lib/JacobsonRank.h"
 
 namespace compact {
@@ -16,25 +18,14 @@ namespace lib {
 template <typename BitArrayType = BitArray>
 class ClarkSelect {
  public:
-  ClarkSelect()
-      : bit_value(1),
-        big_sparse_lookup(NULL),
-        small_sparse_lookup(NULL),
-        big_block_sparse_ptr(NULL),
-        small_block_sparse_ptr(NULL),
-        bit_stream_ptr(NULL) {}
+  ClarkSelect() : bit_value(1), bit_stream_ptr(NULL) {}
 
   ClarkSelect(BitArrayType& bits, uint bit_val = 1) : ClarkSelect() {
     bit_stream_ptr = &bits;
     bit_value = bit_val;
   }
 
-  ~ClarkSelect() {
-    // if (big_sparse_lookup) delete[] big_sparse_lookup;
-    // if (small_sparse_lookup) delete[] small_sparse_lookup;
-    // if (big_block_sparse_ptr) delete big_block_sparse_ptr;
-    // if (small_block_sparse_ptr) delete small_block_sparse_ptr;
-  }
+  ~ClarkSelect() {}
 
   void build() {
     assert(bit_stream_ptr != NULL);
@@ -55,8 +46,8 @@ class ClarkSelect {
     uint big_block = get_big_block(idx);
     if (is_big_block_sparse(big_block)) {  // big block sparse
       uint sparse_index = get_big_sparse_index(big_block);
-      return big_block_select[big_block] +
-             big_sparse_lookup[sparse_index][idx % big_block_weight];
+      return big_block_select.get(big_block) +
+             big_sparse_lookup[sparse_index].get(idx % big_block_weight);
     }
     assert(n_dense_big > 0);
     // big block dense, check small block
@@ -67,14 +58,16 @@ class ClarkSelect {
     // small block sparse, check lookup table
     if (is_small_block_sparse(small_block)) {
       uint sparse_index = get_small_sparse_index(small_block);
-      return big_block_select[big_block] + small_block_select[small_block] +
-             small_sparse_lookup[sparse_index][idx];
+      return big_block_select.get(big_block) +
+             small_block_select.get(small_block) +
+             small_sparse_lookup[sparse_index].get(idx);
     }
     // small block dense, check bitmask
     uint start = get_small_block_offset(small_block);
     uint end =
         std::min(start + BitmaskUtility::kWordSize, bit_stream_ptr->size()) - 1;
-    return big_block_select[big_block] + small_block_select[small_block] +
+    return big_block_select.get(big_block) +
+           small_block_select.get(small_block) +
            BitmaskUtility::select(bit_stream_ptr->read_interval(start, end),
                                   idx, end - start + 1, bit_value);
   }
@@ -129,18 +122,18 @@ class ClarkSelect {
   // logn/2
   uint small_block_threshold;
   // offsets of the beginning of each block
-  FixedSizeArray big_block_select;
-  FixedSizeArray small_block_select;
+  DynamicWidthArray big_block_select;
+  DynamicWidthArray small_block_select;
   // sparse big block lookup table (block, idx_on_block) -> answer
-  FixedSizeArray* big_sparse_lookup;  // O(n/logn)
+  std::vector<DynamicWidthArray> big_sparse_lookup;  // O(n/logn)
   // sparse small block lookup table (subblock, idx_on_subblock) -> answer
-  FixedSizeArray* small_sparse_lookup;  // O(n*loglogn/sqrtlogn)
+  std::vector<DynamicWidthArray> small_sparse_lookup;  // O(n*loglogn/sqrtlogn)
   // answer whether big blocks are sparse
-  BitArrayType* big_block_sparse_ptr;
+  std::unique_ptr<BitArrayType> big_block_sparse_ptr;
   // rank manager for big_block_sparse_ptr bitarray
   JacobsonRank<BitArrayType> big_sparse_rank_manager;
   // answer whether small blocks are sparse
-  BitArrayType* small_block_sparse_ptr;
+  std::unique_ptr<BitArrayType> small_block_sparse_ptr;
   // rank manager for big_block_sparse_ptr bitarray
   JacobsonRank<BitArrayType> small_sparse_rank_manager;
   // bit array
@@ -154,11 +147,11 @@ class ClarkSelect {
     big_block_select.resize(n_big_blocks,
                             logn);                       // O(n/logn) = o(n)
     const uint big_sparse_size = get_big_sparse_size();  // O(n/log^4)
-    big_sparse_lookup = new FixedSizeArray[big_sparse_size];
+    big_sparse_lookup.assign(big_sparse_size, DynamicWidthArray());
     for (uint i = 0; i < big_sparse_size; i++) {
       big_sparse_lookup[i].resize(big_block_weight, logn);  // O(log^3)
     }
-    big_block_sparse_ptr = new BitArrayType(n_big_blocks);
+    big_block_sparse_ptr.reset(new BitArrayType(n_big_blocks));
   }
 
   void setup_small(uint n, uint logn, uint sqrtlogn, uint loglogn) {
@@ -172,12 +165,12 @@ class ClarkSelect {
         rel_val_bit_size);  // O(loglogn*n/sqrtlogn) = o(n)
 
     const uint small_sparse_size = get_small_sparse_size();  // O(n/logn)
-    small_sparse_lookup = new FixedSizeArray[small_sparse_size];
+    small_sparse_lookup.assign(small_sparse_size, DynamicWidthArray());
     for (uint i = 0; i < small_sparse_size; i++) {
       small_sparse_lookup[i].resize(small_block_weight,
                                     rel_val_bit_size);  // O(sqrtlog*loglog)
     }
-    small_block_sparse_ptr = new BitArrayType(n_small_blocks);
+    small_block_sparse_ptr.reset(new BitArrayType(n_small_blocks));
   }
 
   void build_blocks() {
@@ -338,7 +331,7 @@ class ClarkSelect {
 
   uint get_small_block_offset(uint b) const {
     uint bblock = b / small_per_big();
-    return big_block_select[bblock] + small_block_select[b];
+    return big_block_select.get(bblock) + small_block_select.get(b);
   }
 
   uint small_per_big() const {
@@ -363,18 +356,12 @@ class ClarkSelect {
   }
 
   uint get_lookup_memory() const {
-    uint sum = sizeof(FixedSizeArray*) * 2;
-    if (big_sparse_lookup) {
-      uint big_sparse_size = get_big_sparse_size();
-      for (uint i = 0; i < big_sparse_size; i++) {
-        sum += big_sparse_lookup[i].measure_memory();
-      }
+    uint sum = sizeof(big_sparse_lookup) + sizeof(small_sparse_lookup);
+    for (auto& lookup : big_sparse_lookup) {
+      sum += lookup.measure_memory();
     }
-    if (small_sparse_lookup) {
-      uint small_sparse_size = get_small_sparse_size();
-      for (uint i = 0; i < small_sparse_size; i++) {
-        sum += small_sparse_lookup[i].measure_memory();
-      }
+    for (auto& lookup : small_sparse_lookup) {
+      sum += lookup.measure_memory();
     }
     return sum;
   }
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "lib/Array.h"
+#include "lib/BitArray.h"
+#include "lib/BitVector.h"
+#include "lib/FixedSizeArray.h"
+#include "lib/utils/BitmaskUtility.h"
+
+namespace compact {
+namespace lib {
+
+/*
+  Elias-Fano representation of a non-decreasing sequence.
+
+  Each value is split in its low_bits least significant bits, stored as they
+  are on a FixedSizeArray, and the remaining high part, stored in unary on a
+  bitvector: value i sets the bit (value >> low_bits) + i. With
+  low_bits = log(max / n) it takes about 2 + log(max / n) bits per value.
+
+  Access is a select over the high bits, and next_geq is a select over the
+  zeros followed by a short scan over the values sharing the same high part.
+*/
+class EliasFanoArray : public Array {
+ public:
+  EliasFanoArray() : sz(0), low_bits(0) {}
+
+  EliasFanoArray(const std::vector<uint>& values) : EliasFanoArray() {
+    reset(values);
+  }
+
+  EliasFanoArray(const std::initializer_list<uint>& values)
+      : EliasFanoArray(std::vector<uint>(values)) {}
+
+  uint size() const override { return sz; }
+
+  // expects a non-decreasing sequence
+  template <typename ArrayType>
+  void reset(const ArrayType& values) {
+    sz = values.size();
+    low_bits = 0;
+    lower.resize(0);
+    if (!sz) {
+      upper.resize(0);
+      return;
+    }
+    uint max_value = values[sz - 1];
+    low_bits = BitmaskUtility::int_log(max_value / sz);
+    if (low_bits) lower.resize(sz, low_bits);
+
+    BitArray64 bits(sz + (max_value >> low_bits) + 1);
+    for (uint i = 0; i < sz; i++) {
+      if (i && values[i] < values[i - 1]) {
+        throw std::runtime_error(
+            "Elias-Fano sequences must be non-decreasing!");
+      }
+      if (low_bits) lower.write(i, values[i]);
+      bits.write((values[i] >> low_bits) + i, 1);
+    }
+    upper.reset(bits);
+  }
+
+  uint read(uint idx) const override {
+    if (idx >= sz) {
+      throw std::runtime_error(
+          "Read failed! Index " + std::to_string(idx) +
+          " is out of bounds! Array size is: " + std::to_string(sz));
+    }
+    uint high = upper.select(idx, 1) - idx;
+    return (high << low_bits) | get_low(idx);
+  }
+
+  void write(uint idx, uint val) override {
+    throw std::runtime_error(
+        "Elias-Fano array does not support write operations!");
+  }
+
+  // index of the first value >= val, or size() if there is none
+  uint next_geq(uint val) const {
+    if (!sz) return 0;
+    uint high = val >> low_bits;
+    uint n_zeros = upper.size() - sz;
+    if (high >= n_zeros) return sz;
+
+    // values with a smaller high part come before the high-th zero
+    uint pos = high ? upper.select(high - 1, 0) + 1 : 0;
+    uint idx = pos - high;
+    uint low = val & BitmaskUtility::get_full_ones(low_bits);
+    for (; idx < sz && upper[pos]; idx++, pos++) {
+      if (get_low(idx) >= low) break;
+    }
+    return idx;
+  }
+
+  // index of the first value > val, or size() if there is none
+  uint next_gt(uint val) const {
+    return val == UINT32_MAX ? sz : next_geq(val + 1);
+  }
+
+  /*
+    Decode the values on positions [l, r)
+  */
+  void decode_range(uint l, uint r, std::vector<uint>& values) const {
+    values.clear();
+    r = std::min(r, sz);
+    if (l >= r) return;
+    values.reserve(r - l);
+    uint pos = upper.select(l, 1);
+    for (uint i = l; i < r; pos++) {
+      if (!upper[pos]) continue;
+      values.push_back(((pos - i) << low_bits) | get_low(i));
+      i++;
+    }
+  }
+
+  std::string to_string() const {
+    std::vector<uint> values;
+    decode_range(0, sz, values);
+    std::string str("[");
+    for (uint i = 0; i < values.size(); i++) {
+      if (i) str += ",";
+      str += std::to_string(values[i]);
+    }
+    return str + "]";
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const override {
+    return sizeof(sz) + sizeof(low_bits) + lower.measure_memory() +
+           upper.measure_memory();
+  }
+
+ private:
+  uint sz;
+  uint low_bits;
+  // low_bits least significant bits of each value
+  FixedSizeArray lower;
+  // high part of each value in unary
+  BitVector64 upper;
+
+  uint get_low(uint idx) const { return low_bits ? lower[idx] : 0; }
+};
+
+}  // namespace lib
+}  // namespace compact
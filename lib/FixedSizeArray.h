@@ -1,35 +1,52 @@
 #pragma once
 
 #include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
 #include "glog/logging.h"
 #include "lib/Array.h"
+#include "lib/ArrayCursor.h"
+#include "lib/utils/AccessPolicy.h"
 #include "lib/utils/BitmaskUtility.h"
 
 namespace compact {
 namespace lib {
 
-class FixedSizeArray : public Array {
+/*
+  Array of fixed-length elements (up to BitmaskUtility::kWordSize bits each)
+  packed on cells of type WordType. Use FixedSizeArray for 32-bit cells and
+  FixedSizeArray64 for 64-bit cells.
+*/
+template <typename WordType = uint>
+class BasicFixedSizeArray : public Array {
  public:
-  FixedSizeArray() : sz(0), bit_size(1), array_size(0), array(NULL) {}
+  using Word = WordType;
+  using Mask = WordBitmaskUtility<WordType>;
 
-  ~FixedSizeArray() {
-    if (array) {
-      delete[] array;
-    }
-  }
+  // size of a storage cell, measured in bits
+  static constexpr uint kCellSize = Mask::kWordSize;
+  // 64-bit cells are allocated aligned to a cache line
+  static constexpr uint kAlignment =
+      kCellSize == 64 ? 64 : alignof(WordType);
+
+  BasicFixedSizeArray() : sz(0), bit_size(1), array_size(0), array(NULL) {}
+
+  ~BasicFixedSizeArray() { release_array(); }
 
-  FixedSizeArray(uint n, uint bit_size = BitmaskUtility::kWordSize) {
+  BasicFixedSizeArray(uint n, uint bit_size = BitmaskUtility::kWordSize) {
     array = NULL;
     this->bit_size = bit_size;
     setup_array(n);
   }
 
-  FixedSizeArray(const std::vector<uint>& values,
-                 uint bit_size = BitmaskUtility::kWordSize) {
+  BasicFixedSizeArray(const std::vector<uint>& values,
+                      uint bit_size = BitmaskUtility::kWordSize) {
     array = NULL;
     this->bit_size = bit_size;
     setup_array(values.size());
@@ -38,9 +55,38 @@ class FixedSizeArray : public Array {
     }
   }
 
-  FixedSizeArray(const std::initializer_list<uint>& values,
-                 uint bit_size = BitmaskUtility::kWordSize)
-      : FixedSizeArray(std::vector<uint>(values), bit_size) {}
+  BasicFixedSizeArray(const std::initializer_list<uint>& values,
+                      uint bit_size = BitmaskUtility::kWordSize)
+      : BasicFixedSizeArray(std::vector<uint>(values), bit_size) {}
+
+  BasicFixedSizeArray(const BasicFixedSizeArray& other)
+      : BasicFixedSizeArray() {
+    *this = other;
+  }
+
+  BasicFixedSizeArray(BasicFixedSizeArray&& other) : BasicFixedSizeArray() {
+    *this = std::move(other);
+  }
+
+  BasicFixedSizeArray& operator=(const BasicFixedSizeArray& other) {
+    if (this == &other) return *this;
+    bit_size = other.bit_size;
+    setup_array(other.sz);
+    if (array_size) memcpy(array, other.array, array_size * sizeof(WordType));
+    return *this;
+  }
+
+  BasicFixedSizeArray& operator=(BasicFixedSizeArray&& other) {
+    if (this == &other) return *this;
+    release_array();
+    sz = other.sz;
+    bit_size = other.bit_size;
+    array_size = other.array_size;
+    array = other.array;
+    other.sz = other.array_size = 0;
+    other.array = NULL;
+    return *this;
+  }
 
   uint size() const override { return sz; }
 
@@ -67,7 +113,7 @@ class FixedSizeArray : public Array {
   }
 
   uint read(uint idx) const override {
-    if (!is_index_valid(idx)) {
+    if (kCheckedAccess && !is_index_valid(idx)) {
       throw std::runtime_error(
           "Read failed! Index " + std::to_string(idx) +
           " is out of bounds! Array size is: " + std::to_string(sz));
@@ -77,7 +123,7 @@ class FixedSizeArray : public Array {
   }
 
   void write(uint idx, uint val) override {
-    if (!is_index_valid(idx)) {
+    if (kCheckedAccess && !is_index_valid(idx)) {
       throw std::runtime_error(
           "Write failed! Index " + std::to_string(idx) +
           " is out of bounds! Array size is: " + std::to_string(sz));
@@ -86,27 +132,67 @@ class FixedSizeArray : public Array {
     write_bit_interval(bitInterval.first, bitInterval.second, val);
   }
 
-  uint read_bit_interval(uint startBit, uint endBit) const {
+  WordType read_bit_interval(uint startBit, uint endBit) const {
     check_bit_interval(startBit, endBit);
-    uint startPos = startBit / BitmaskUtility::kWordSize;  // position in array
-    uint startOffset =
-        startBit % BitmaskUtility::kWordSize;  // position in array cell
+    uint startPos = startBit / kCellSize;     // position in array
+    uint startOffset = startBit % kCellSize;  // position in array cell
 
-    uint endPos = endBit / BitmaskUtility::kWordSize;  // position in array
-    uint endOffset =
-        endBit % BitmaskUtility::kWordSize;  // position in array cell
+    uint endPos = endBit / kCellSize;     // position in array
+    uint endOffset = endBit % kCellSize;  // position in array cell
 
     if (startPos == endPos) {
       return read_incell_interval(startPos, startOffset, endOffset);
     }
-    uint leftPart = read_incell_interval(startPos, startOffset,
-                                         BitmaskUtility::kWordSize - 1);
-    uint rightPart = read_incell_interval(endPos, 0, endOffset);
+    WordType leftPart =
+        read_incell_interval(startPos, startOffset, kCellSize - 1);
+    WordType rightPart = read_incell_interval(endPos, 0, endOffset);
     return (leftPart << (endOffset + 1)) | rightPart;
   }
 
+  // forward cursor, reading the packed values without bounds checking
+  class Cursor : public ArrayCursor<Cursor> {
+   public:
+    using ArrayCursor<Cursor>::operator++;
+
+    Cursor() : arr(NULL), idx(0), bit(0) {}
+
+    Cursor(const BasicFixedSizeArray* arr, uint idx)
+        : arr(arr), idx(idx), bit(uint64_t(idx) * arr->bit_size) {}
+
+    uint operator*() const { return arr->read_unchecked(bit); }
+
+    Cursor& operator++() {
+      idx++;
+      bit += arr->bit_size;
+      return *this;
+    }
+
+    uint index() const { return idx; }
+
+   private:
+    const BasicFixedSizeArray* arr;
+    uint idx;
+    // first bit of the element on position idx
+    uint64_t bit;
+  };
+
+  Cursor begin() const { return Cursor(this, 0); }
+
+  Cursor end() const { return Cursor(this, sz); }
+
+  // cursor pointing to position idx
+  Cursor cursor(uint idx) const { return Cursor(this, std::min(idx, sz)); }
+
   uint get_bit_size() const { return this->bit_size; }
 
+  // number of storage cells used by the array
+  uint cell_count() const { return array_size; }
+
+  // raw access to a whole storage cell, no bounds checking
+  WordType read_cell(uint idx) const { return array[idx]; }
+
+  void write_cell(uint idx, WordType val) { array[idx] = val; }
+
   std::string to_string() const {
     if (size() == 0) {
       return "[]";
@@ -129,15 +215,28 @@ class FixedSizeArray : public Array {
   uint sz;
   uint bit_size;
   uint array_size;
-  uint* array;
+  WordType* array;
 
   void setup_array(uint n) {
     sz = n;
-    array_size = std::ceil(1.0 * (n * bit_size) / BitmaskUtility::kWordSize);
+    array_size = (uint64_t(n) * bit_size + kCellSize - 1) / kCellSize;
+    release_array();
+    if (!array_size) return;
+    // aligned_alloc requires the size to be a multiple of the alignment
+    size_t bytes = array_size * sizeof(WordType);
+    bytes = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    array = static_cast<WordType*>(aligned_alloc(kAlignment, bytes));
+    if (!array) {
+      throw std::bad_alloc();
+    }
+    memset(array, 0, bytes);
+  }
+
+  void release_array() {
     if (array) {
-      delete[] array;
+      free(array);
+      array = NULL;
     }
-    array = new uint[array_size]();
   }
 
   bool is_index_valid(uint idx) const { return idx >= 0 && idx < sz; }
@@ -146,41 +245,51 @@ class FixedSizeArray : public Array {
     return {idx * bit_size, int((idx + 1) * bit_size) - 1};
   }
 
-  uint read_incell_interval(uint idx, uint l, uint r) const {
-    return BitmaskUtility::get_mask_interval(array[idx], l, r) >> l;
+  // value of the element starting at the given bit, no bounds checking
+  uint read_unchecked(uint64_t start_bit) const {
+    uint pos = start_bit / kCellSize;
+    uint offset = start_bit % kCellSize;
+    if (offset + bit_size <= kCellSize) {
+      return (array[pos] >> offset) & Mask::get_full_ones(bit_size);
+    }
+    // straddling two cells, the high bits of the element are on the first one
+    uint low_bits = offset + bit_size - kCellSize;
+    return ((array[pos] >> offset) << low_bits) |
+           (array[pos + 1] & Mask::get_full_ones(low_bits));
+  }
+
+  WordType read_incell_interval(uint idx, uint l, uint r) const {
+    return Mask::get_mask_interval(array[idx], l, r) >> l;
   }
 
-  void write_bit_interval(uint startBit, uint endBit, uint val) {
+  void write_bit_interval(uint startBit, uint endBit, WordType val) {
     check_bit_interval(startBit, endBit);
-    uint startPos = startBit / BitmaskUtility::kWordSize;  // position in array
-    uint startOffset =
-        startBit % BitmaskUtility::kWordSize;  // position in array cell
+    uint startPos = startBit / kCellSize;     // position in array
+    uint startOffset = startBit % kCellSize;  // position in array cell
 
-    uint endPos = endBit / BitmaskUtility::kWordSize;  // position in array
-    uint endOffset =
-        endBit % BitmaskUtility::kWordSize;  // position in array cell
+    uint endPos = endBit / kCellSize;     // position in array
+    uint endOffset = endBit % kCellSize;  // position in array cell
 
     if (startPos == endPos) {
       write_incell_interval(startPos, startOffset, endOffset, val);
       return;
     }
 
-    uint leftPart = val >> (endOffset + 1);
-    uint rightPart = val & BitmaskUtility::get_full_ones(endOffset + 1);
-    write_incell_interval(startPos, startOffset, BitmaskUtility::kWordSize - 1,
-                          leftPart);
+    WordType leftPart = val >> (endOffset + 1);
+    WordType rightPart = val & Mask::get_full_ones(endOffset + 1);
+    write_incell_interval(startPos, startOffset, kCellSize - 1, leftPart);
     write_incell_interval(endPos, 0, endOffset, rightPart);
   }
 
-  void write_incell_interval(uint idx, uint l, uint r, uint val) {
-    uint croppedVal = BitmaskUtility::get_mask_prefix(val, bit_size - 1);
-    uint v = BitmaskUtility::clear_mask_interval(array[idx], l, r);
+  void write_incell_interval(uint idx, uint l, uint r, WordType val) {
+    WordType croppedVal = Mask::get_mask_prefix(val, bit_size - 1);
+    WordType v = Mask::clear_mask_interval(array[idx], l, r);
     array[idx] = v | (croppedVal << l);
   }
 
   static void check_bit_interval(uint startBit, uint endBit) {
-    if (startBit > endBit ||
-        (endBit - startBit + 1) > BitmaskUtility::kWordSize) {
+    if (kCheckedAccess &&
+        (startBit > endBit || (endBit - startBit + 1) > kCellSize)) {
       throw std::runtime_error(
           "Invalid bit interval! Interval should fit in a word len");
     }
@@ -192,5 +301,8 @@ class FixedSizeArray : public Array {
   }
 };
 
+using FixedSizeArray = BasicFixedSizeArray<uint>;
+using FixedSizeArray64 = BasicFixedSizeArray<uint64_t>;
+
 }  // namespace lib
 }  // namespace compact
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "lib/Array.h"
+#include "lib/utils/AccessPolicy.h"
+#include "lib/utils/BitmaskUtility.h"
+
+namespace compact {
+namespace lib {
+
+// widths supported by FixedWidthArray, measured in bits
+static constexpr uint kMaxFixedWidth = 32;
+
+/*
+  Array of W-bit elements, W known at compile time (1 <= W <= 32), packed LSB
+  first on 64-bit cells.
+
+  A trailing padding cell lets every access load the two cells an element may
+  straddle unconditionally, so get() and set() are branch-free, inline and
+  non-virtual: a multiplication by a constant, two loads, shifts and a mask.
+  read() and write() keep the bounds checks of the Array interface.
+*/
+template <uint W>
+class FixedWidthArray : public Array {
+  static_assert(W >= 1 && W <= kMaxFixedWidth,
+                "Invalid FixedWidthArray width");
+
+ public:
+  static constexpr uint kWidth = W;
+
+  FixedWidthArray() : sz(0), cells(1, 0) {}
+
+  FixedWidthArray(uint n) : FixedWidthArray() { resize(n); }
+
+  FixedWidthArray(const std::vector<uint>& values) : FixedWidthArray() {
+    reset(values);
+  }
+
+  FixedWidthArray(const std::initializer_list<uint>& values)
+      : FixedWidthArray(std::vector<uint>(values)) {}
+
+  uint size() const override { return sz; }
+
+  // n zeroed elements
+  void resize(uint n) {
+    sz = n;
+    cells.assign(cell_count(n, W), 0);
+  }
+
+  template <typename ArrayType>
+  void reset(const ArrayType& values) {
+    resize(values.size());
+    for (uint i = 0; i < sz; i++) set(i, values[i]);
+  }
+
+  void assign(uint n, uint val) {
+    resize(n);
+    for (uint i = 0; i < n; i++) set(i, val);
+  }
+
+  // no bounds checking
+  uint get(uint idx) const { return get(cells.data(), idx); }
+
+  // no bounds checking, only the W least significant bits of val are kept
+  void set(uint idx, uint val) { set(cells.data(), idx, val); }
+
+  uint read(uint idx) const override {
+    check_index(idx);
+    return get(idx);
+  }
+
+  void write(uint idx, uint val) override {
+    check_index(idx);
+    set(idx, val);
+  }
+
+  std::string to_string() const {
+    std::string str("[");
+    for (uint i = 0; i < sz; i++) {
+      if (i) str += ",";
+      str += std::to_string(get(i));
+    }
+    return str + "]";
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const override {
+    return sizeof(sz) + cells.size() * sizeof(uint64_t);
+  }
+
+  // element idx of the W-bit elements packed on cells
+  static uint get(const uint64_t* cells, uint idx) {
+    uint64_t bit = uint64_t(idx) * W;
+    uint pos = bit >> 6, offset = bit & 63;
+    // the bits spilling to the next cell, if any; two shifts as offset may be 0
+    uint64_t high = (cells[pos + 1] << 1) << (63 - offset);
+    return ((cells[pos] >> offset) | high) & kMask;
+  }
+
+  static void set(uint64_t* cells, uint idx, uint val) {
+    uint64_t bit = uint64_t(idx) * W;
+    uint pos = bit >> 6, offset = bit & 63;
+    uint64_t value = val & kMask;
+    cells[pos] = (cells[pos] & ~(kMask << offset)) | (value << offset);
+    uint64_t spill_mask = (kMask >> 1) >> (63 - offset);
+    cells[pos + 1] =
+        (cells[pos + 1] & ~spill_mask) | ((value >> 1) >> (63 - offset));
+  }
+
+  // cells needed by n elements of the given width, padding included
+  static uint cell_count(uint n, uint width) {
+    return (uint64_t(n) * width + 63) / 64 + 1;
+  }
+
+ private:
+  static constexpr uint64_t kMask = (uint64_t(1) << W) - 1;
+
+  uint sz;
+  std::vector<uint64_t> cells;
+
+  void check_index(uint idx) const {
+    if (kCheckedAccess && idx >= sz) {
+      throw std::runtime_error(
+          "Access failed! Index " + std::to_string(idx) +
+          " is out of bounds! Array size is: " + std::to_string(sz));
+    }
+  }
+};
+
+/*
+  Call f with std::integral_constant<uint, width>, so code written once for
+  a compile-time width runs on the FixedWidthArray<width> instantiation.
+*/
+template <typename F, uint... Ws>
+void dispatch_fixed_width(uint width, F&& f,
+                          std::integer_sequence<uint, Ws...>) {
+  bool found = ((width == Ws + 1
+                     ? (f(std::integral_constant<uint, Ws + 1>()), true)
+                     : false) ||
+                ...);
+  if (!found) {
+    throw std::runtime_error("Invalid fixed width " + std::to_string(width) +
+                             "! Should be between 1 and " +
+                             std::to_string(kMaxFixedWidth));
+  }
+}
+
+template <typename F>
+void dispatch_fixed_width(uint width, F&& f) {
+  dispatch_fixed_width(width, f,
+                       std::make_integer_sequence<uint, kMaxFixedWidth>());
+}
+
+/*
+  FixedWidthArray whose width is only known when the structure is built. The
+  dispatcher picks the accessors of the matching FixedWidthArray<W> on
+  resize, so every access is one call to a branch-free function specialized
+  for the width, with no per-access bounds or interval checks.
+*/
+class DynamicWidthArray : public Array {
+ public:
+  DynamicWidthArray()
+      : sz(0), width(0), cells(1, 0), getter(NULL), setter(NULL) {}
+
+  DynamicWidthArray(uint n, uint width) : DynamicWidthArray() {
+    resize(n, width);
+  }
+
+  uint size() const override { return sz; }
+
+  uint get_bit_size() const { return width; }
+
+  // n zeroed elements of the given width, between 1 and kMaxFixedWidth
+  void resize(uint n, uint width) {
+    dispatch_fixed_width(width, [this](auto w) {
+      getter = &FixedWidthArray<decltype(w)::value>::get;
+      setter = &FixedWidthArray<decltype(w)::value>::set;
+    });
+    this->sz = n;
+    this->width = width;
+    cells.assign(FixedWidthArray<1>::cell_count(n, width), 0);
+  }
+
+  template <typename ArrayType>
+  void reset(const ArrayType& values, uint width) {
+    resize(values.size(), width);
+    for (uint i = 0; i < sz; i++) set(i, values[i]);
+  }
+
+  void assign(uint n, uint val, uint width) {
+    resize(n, width);
+    for (uint i = 0; i < n; i++) set(i, val);
+  }
+
+  // no bounds checking
+  uint get(uint idx) const { return getter(cells.data(), idx); }
+
+  // no bounds checking, only the width least significant bits are kept
+  void set(uint idx, uint val) { setter(cells.data(), idx, val); }
+
+  uint read(uint idx) const override {
+    check_index(idx);
+    return get(idx);
+  }
+
+  void write(uint idx, uint val) override {
+    check_index(idx);
+    set(idx, val);
+  }
+
+  std::string to_string() const {
+    std::string str("[");
+    for (uint i = 0; i < sz; i++) {
+      if (i) str += ",";
+      str += std::to_string(get(i));
+    }
+    return str + "]";
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const override {
+    return sizeof(sz) + sizeof(width) + cells.size() * sizeof(uint64_t);
+  }
+
+ private:
+  uint sz;
+  uint width;
+  std::vector<uint64_t> cells;
+  uint (*getter)(const uint64_t*, uint);
+  void (*setter)(uint64_t*, uint, uint);
+
+  void check_index(uint idx) const {
+    if (kCheckedAccess && idx >= sz) {
+      throw std::runtime_error(
+          "Access failed! Index " + std::to_string(idx) +
+          " is out of bounds! Array size is: " + std::to_string(sz));
+    }
+  }
+};
+
+}  // namespace lib
+}  // namespace compact
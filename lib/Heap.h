@@ -5,7 +5,7 @@
 #include <functional>
 #include <string>
 
-#include "lib/FixedSizeArray.h"
+#include "lib/FixedWidthArray.h"
 #include "lib/utils/BitmaskUtility.h"
 
 namespace compact {
@@ -35,7 +35,7 @@ class Heap {
   void push(uint elem) {
     check_full();
     uint pos = sz++;
-    heap.write(pos, elem);
+    heap.set(pos, elem);
     bubble_up(pos);
   }
 
@@ -43,12 +43,12 @@ class Heap {
     check_empty();
     swap_nodes(0, --sz);
     bubble_down(0);
-    return heap[sz];
+    return heap.get(sz);
   }
 
   uint top() const {
     check_empty();
-    return heap[0];
+    return heap.get(0);
   }
 
   uint size() const { return sz; }
@@ -62,7 +62,7 @@ class Heap {
   }
 
  private:
-  FixedSizeArray heap;
+  DynamicWidthArray heap;
   uint max_size;
   uint sz;
   Comparator comparator;
@@ -77,8 +77,8 @@ class Heap {
   void bubble_up(uint pos) {
     while (pos > 0) {
       uint parent = get_parent(pos);
-      uint pos_val = heap[pos];
-      uint parent_val = heap[parent];
+      uint pos_val = heap.get(pos);
+      uint parent_val = heap.get(parent);
       if (comparator(pos_val, parent_val)) {
         swap_nodes(parent, pos);
         pos = parent;
@@ -94,8 +94,8 @@ class Heap {
       uint right_child = get_right(pos);
 
       if (left_child < sz && right_child < sz) {
-        uint left_val = heap[left_child];
-        uint right_val = heap[right_child];
+        uint left_val = heap.get(left_child);
+        uint right_val = heap.get(right_child);
 
         //
         if (/* left child is best */ (comparator(left_val, right_val) &&
@@ -115,8 +115,8 @@ class Heap {
   bool bubble_left(uint& pos) {
     if (get_left(pos) >= sz) return false;
     uint left_child = get_left(pos);
-    uint pos_val = heap[pos];
-    uint left_val = heap[left_child];
+    uint pos_val = heap.get(pos);
+    uint left_val = heap.get(left_child);
 
     if (comparator(left_val, pos_val)) {
       swap_nodes(pos, left_child);
@@ -130,8 +130,8 @@ class Heap {
   bool bubble_right(uint& pos) {
     if (get_right(pos) >= sz) return false;
     uint right_child = get_right(pos);
-    uint pos_val = heap[pos];
-    uint right_val = heap[right_child];
+    uint pos_val = heap.get(pos);
+    uint right_val = heap.get(right_child);
 
     if (comparator(right_val, pos_val)) {
       swap_nodes(pos, right_child);
@@ -152,9 +152,9 @@ class Heap {
   uint get_right(uint pos) const { return (pos << 1) + 2; }
 
   void swap_nodes(uint a, uint b) {
-    uint val_a = heap[a];
-    heap.write(a, heap[b]);
-    heap.write(b, val_a);
+    uint val_a = heap.get(a);
+    heap.set(a, heap.get(b));
+    heap.set(b, val_a);
   }
 
   void check_empty() const {
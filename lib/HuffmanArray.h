@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "lib/Array.h"
+#include "lib/ArrayCursor.h"
+#include "lib/BitArray.h"
+#include "lib/BitStream.h"
+#include "lib/FixedSizeArray.h"
+#include "lib/utils/BitmaskUtility.h"
+#include "lib/utils/DeltaGapUtility.h"
+#include "lib/utils/HuffmanUtility.h"
+
+namespace compact {
+namespace lib {
+
+/*
+  Read-only array compressed with deltaGap followed by huffman.
+
+  Every sample_rate-th value has its absolute value and the position of its
+  code on the bit stream sampled, so a read only decodes from the closest
+  sample up to the requested position. On non-decreasing arrays, lower_bound
+  binary searches the samples and decodes a single block.
+*/
+class HuffmanArray : public Array {
+ public:
+  using Container = std::vector<uint>;
+
+  static const uint kDefaultSampleRate = 32;
+
+  HuffmanArray(uint sample_rate = kDefaultSampleRate)
+      : sz(0), sample_rate(sample_rate) {}
+
+  HuffmanArray(const std::vector<uint>& values,
+               uint sample_rate = kDefaultSampleRate)
+      : HuffmanArray(sample_rate) {
+    reset(values);
+  }
+
+  uint size() const override { return sz; }
+
+  template <typename ArrayType>
+  void reset(const ArrayType& values) {
+    sz = values.size();
+    bit_stream.resize(0);
+    huff.encode(dgap.get_array_code(values), bit_stream);
+    build_samples(values);
+  }
+
+  uint read(uint idx) const override {
+    if (kCheckedAccess && idx >= sz) {
+      throw std::runtime_error(
+          "Read failed! Index " + std::to_string(idx) +
+          " is out of bounds! Array size is: " + std::to_string(sz));
+    }
+    return *cursor(idx);
+  }
+
+  void write(uint idx, uint val) override {
+    throw std::runtime_error(
+        "Huffman array does not support write operations!");
+  }
+
+  /*
+    Decode the values on positions [l, r)
+  */
+  void decode_range(uint l, uint r, Container& values) const {
+    values.clear();
+    r = std::min(r, sz);
+    if (l >= r) return;
+
+    values.reserve(r - l);
+    for (Cursor it = cursor(l); it.index() < r; ++it) values.push_back(*it);
+  }
+
+  void decode(Container& values) const { decode_range(0, sz, values); }
+
+  // forward cursor, decoding each value right after the previous one
+  class Cursor : public ArrayCursor<Cursor> {
+   public:
+    using ArrayCursor<Cursor>::operator++;
+
+    Cursor() : arr(NULL), idx(0), value(0) {}
+
+    Cursor(const HuffmanArray* arr, uint idx) : arr(arr), idx(idx), value(0) {
+      if (idx >= arr->sz) return;
+      uint pos;
+      value = arr->seek(idx / arr->sample_rate, pos);
+      reader = BitReader(arr->bit_stream, pos);
+      for (uint i = idx - idx % arr->sample_rate; i < idx; i++) next();
+    }
+
+    uint operator*() const { return value; }
+
+    Cursor& operator++() {
+      if (++idx < arr->sz) next();
+      return *this;
+    }
+
+    uint index() const { return idx; }
+
+   private:
+    const HuffmanArray* arr;
+    uint idx;
+    BitReader reader;
+    // decoded value on position idx
+    uint value;
+
+    void next() {
+      value = arr->dgap.decode_next(value, arr->huff.decode_next(reader));
+    }
+  };
+
+  Cursor begin() const { return Cursor(this, 0); }
+
+  Cursor end() const { return Cursor(this, sz); }
+
+  // cursor pointing to position idx
+  Cursor cursor(uint idx) const { return Cursor(this, std::min(idx, sz)); }
+
+  /*
+    Position of the first value not less than the given one, or size() if
+    there is none. Expects a non-decreasing array.
+  */
+  uint lower_bound(uint value) const {
+    if (!sz) return 0;
+
+    // last block starting with a value less than the given one
+    uint pos;
+    uint low = 0, high = (sz - 1) / sample_rate;
+    while (low < high) {
+      uint mid = low + (high - low + 1) / 2;
+      if (seek(mid, pos) < value) {
+        low = mid;
+      } else {
+        high = mid - 1;
+      }
+    }
+
+    uint idx = low * sample_rate;
+    uint end = std::min(sz, idx + sample_rate);
+    uint curr = seek(low, pos);
+    BitReader reader(bit_stream, pos);
+    while (curr < value && ++idx < end) {
+      curr = dgap.decode_next(curr, huff.decode_next(reader));
+    }
+    return idx;
+  }
+
+  std::string to_string() const {
+    Container values;
+    decode(values);
+    std::string str("[");
+    for (uint i = 0; i < values.size(); i++) {
+      if (i) str += ",";
+      str += std::to_string(values[i]);
+    }
+    return str + "]";
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const override {
+    return sizeof(sz) + sizeof(sample_rate) + bit_stream.measure_memory() +
+           dgap.measure_memory() + huff.measure_memory() +
+           sample_positions.measure_memory() + sample_values.measure_memory();
+  }
+
+ private:
+  uint sz;
+  uint sample_rate;
+  BitArray bit_stream;
+  DeltaGapUtility dgap;
+  HuffmanUtility huff;
+  /*
+    position on the bit_stream and absolute value of the first element of each
+    block but the first one, which starts at the beginning of the stream and
+    is stored without the deltaGap
+  */
+  FixedSizeArray sample_positions, sample_values;
+
+  template <typename ArrayType>
+  void build_samples(const ArrayType& values) {
+    std::vector<uint> positions, absolute;
+    uint max_value = 0;
+    BitReader reader(bit_stream);
+    for (uint i = 0; i < sz; i++) {
+      if (i && !(i % sample_rate)) {
+        positions.push_back(reader.position());
+        absolute.push_back(values[i]);
+        max_value = std::max(max_value, (uint)values[i]);
+      }
+      huff.decode_next(reader);
+    }
+    sample_positions.reset(positions,
+                           1 + BitmaskUtility::int_log(bit_stream.size()));
+    sample_values.reset(absolute, 1 + BitmaskUtility::int_log(max_value));
+  }
+
+  /*
+    Return the first value of the given block, and set pos to the beginning of
+    the code of the value right after it
+  */
+  uint seek(uint block, uint& pos) const {
+    if (!block) {
+      pos = 0;
+      return huff.decode_next(bit_stream, pos);
+    }
+    pos = sample_positions[block - 1];
+    huff.decode_next(bit_stream, pos);
+    return sample_values[block - 1];
+  }
+};
+
+}  // namespace lib
+}  // namespace compact
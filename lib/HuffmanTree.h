@@ -10,6 +10,7 @@
 
 #include "glog/logging.h"
 #include "lib/BitArray.h"
+#include "lib/BitStream.h"
 #include "lib/FixedSizeArray.h"
 #include "lib/Heap.h"
 
@@ -53,16 +54,17 @@ class HuffmanBitTree {
     this->leaf_bit_size = leaf_bit_size;
     bit_tree.resize(tree_size + leaves * leaf_bit_size);
 
-    uint idx = 0;
-    build_pre_order(root, idx);
+    BitWriter writer(bit_tree);
+    build_pre_order(root, writer);
+    writer.flush();
   }
 
   Node* get_tree() const {
     if (bit_tree.size() == 0) {
       return NULL;
     }
-    uint idx = 0;
-    return get_tree_pre_order(idx);
+    BitReader reader(bit_tree);
+    return get_tree_pre_order(reader);
   }
 
   std::string to_string() const { return bit_tree.to_string(); }
@@ -77,49 +79,44 @@ class HuffmanBitTree {
   // number of bits necessary to store the label of the leaves
   uint leaf_bit_size;
 
-  void build_pre_order(const Node* root, uint& idx) {
+  void build_pre_order(const Node* root, BitWriter& writer) {
     // leaf
     if (!root->left && !root->right) {
-      bit_tree.write(idx++, 1);
-      write_value(root->val, idx);
+      writer.write_bit(1);
+      write_value(root->val, writer);
       return;
     }
-    bit_tree.write(idx++, 0);
-    build_pre_order(root->left, idx);
-    build_pre_order(root->right, idx);
+    writer.write_bit(0);
+    build_pre_order(root->left, writer);
+    build_pre_order(root->right, writer);
   }
 
-  Node* get_tree_pre_order(uint& idx) const {
+  Node* get_tree_pre_order(BitReader& reader) const {
     Node* root;
     root = new Node();
     // leaf
-    if (bit_tree[idx++] == 1) {
-      root->val = read_value(idx);
+    if (reader.read_bit() == 1) {
+      root->val = read_value(reader);
       return root;
     }
-    root->left = get_tree_pre_order(idx);
-    root->right = get_tree_pre_order(idx);
+    root->left = get_tree_pre_order(reader);
+    root->right = get_tree_pre_order(reader);
     return root;
   }
 
   /*
-    write the value on the bit_tree bitstream using bit_size bits
+    write the value on the bit_tree bitstream using bit_size bits, most
+    significant first
   */
-  void write_value(uint val, uint& idx) {
-    for (int i = leaf_bit_size - 1; i >= 0; i--) {
-      bit_tree.write(idx++, 1 & (val >> i));
-    }
+  void write_value(uint val, BitWriter& writer) const {
+    writer.write_reversed(val, leaf_bit_size);
   }
 
   /*
     read the value on the bit_tree bitstream using bit_size bits
   */
-  uint read_value(uint& idx) const {
-    uint val = 0;
-    for (uint i = 0; i < leaf_bit_size; i++) {
-      val = (val << 1) | bit_tree[idx++];
-    }
-    return val;
+  uint read_value(BitReader& reader) const {
+    return reader.read_reversed(leaf_bit_size);
   }
 };
 
@@ -328,5 +325,268 @@ class HuffmanTree {
   }
 };
 
+/*
+  Canonical, length-limited Huffman code with table-driven decoding.
+
+  The code lengths come from a regular HuffmanTree, limited to kMaxCodeLength
+  bits, and the codes are assigned in (length, label) order. So the code is
+  stored as the labels in that order plus the number of codes of each length.
+
+  Decoding reads lookup_bits bits at once and resolves every code up to that
+  length with a single table access. Longer codes fall back to the canonical
+  decoding using the length counters.
+*/
+class CanonicalHuffmanTree {
+ public:
+  using ii = HuffmanTree::ii;
+  using ContainerType = HuffmanTree::ContainerType;
+  using FrequencyContainer = HuffmanTree::FrequencyContainer;
+  using CodeContainer = HuffmanTree::CodeContainer;
+
+  // maximum length of a code, measured in bits
+  static const uint kMaxCodeLength = 24;
+  // maximum number of bits resolved by a single table access
+  static constexpr uint kLookupBits = 8;
+  // bits used by a table entry to store the code length
+  static const uint kLengthBitSize = 4;
+
+  CanonicalHuffmanTree() : max_length(0), lookup_bits(0) {}
+
+  /*
+    Build the canonical code for the given pairs (label, frequency), sorted by
+    label, and fill the dictionary {label: {code, code_size}}. The codes are
+    stored with their first bit on the least significant position.
+  */
+  void build(const FrequencyContainer& freq, CodeContainer& codes) {
+    codes.clear();
+    max_length = lookup_bits = 0;
+    symbols.resize(0);
+    length_count.resize(0);
+    table.resize(0);
+    if (freq.empty()) return;
+
+    std::vector<uint> lengths;
+    get_code_lengths(freq, lengths);
+    limit_code_lengths(lengths);
+
+    // canonical order: by code length, then by label
+    const uint leaves = freq.size();
+    std::vector<uint> order(leaves);
+    for (uint i = 0; i < leaves; i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&lengths](uint a, uint b) {
+                       return lengths[a] < lengths[b];
+                     });
+    max_length = lengths[order.back()];
+
+    uint leaf_bit_size = 1 + BitmaskUtility::int_log(freq.back().first);
+    symbols.resize(leaves, leaf_bit_size);
+    length_count.assign(max_length + 1, 0,
+                        1 + BitmaskUtility::int_log(leaves));
+
+    uint code = 0;
+    for (uint i = 0; i < leaves; i++) {
+      uint len = lengths[order[i]];
+      if (i) code = (code + 1) << (len - lengths[order[i - 1]]);
+      symbols.write(i, freq[order[i]].first);
+      length_count.write(len, length_count[len] + 1);
+      codes[freq[order[i]].first] = {reverse_code(code, len), len};
+    }
+    build_table(lengths, order);
+  }
+
+  void decode(const BitArray& bit_stream, ContainerType& values) const {
+    values.clear();
+    if (!bit_stream.size() || !symbols.size()) return;
+
+    BitReader reader(bit_stream);
+    while (!reader.empty()) {
+      values.push_back(decode_next(reader));
+    }
+  }
+
+  /*
+    Decode the code starting at position idx of the bit_stream, moving idx to
+    the beginning of the next one.
+  */
+  uint decode_next(const BitArray& bit_stream, uint& idx) const {
+    uint end = std::min(idx + lookup_bits, bit_stream.size());
+    uint window = bit_stream.read_interval(idx, end - 1);
+    uint entry = table[window];
+    uint len = entry & BitmaskUtility::get_full_ones(kLengthBitSize);
+    if (len && idx + len <= end) {
+      idx += len;
+      return symbols[entry >> kLengthBitSize];
+    }
+    uint n_bits =
+        idx < bit_stream.size() ? std::min(max_length, bit_stream.size() - idx)
+                                : 0;
+    window = n_bits ? bit_stream.read_interval(idx, idx + n_bits - 1) : 0;
+    uint symbol = decode_slow(window, n_bits, len);
+    idx += len;
+    return symbol;
+  }
+
+  /*
+    Decode the code at the current position of the reader and consume it.
+    Meant for sequential decoding, as the reader keeps the upcoming bits
+    buffered between calls.
+  */
+  uint decode_next(BitReader& reader) const {
+    uint n_bits =
+        reader.empty()
+            ? 0
+            : std::min(max_length, reader.size() - reader.position());
+    uint entry = table[reader.peek(lookup_bits)];
+    uint len = entry & BitmaskUtility::get_full_ones(kLengthBitSize);
+    if (len && len <= n_bits) {
+      reader.skip(len);
+      return symbols[entry >> kLengthBitSize];
+    }
+    uint symbol = decode_slow(reader.peek(n_bits), n_bits, len);
+    reader.skip(len);
+    return symbol;
+  }
+
+  std::string to_string() const {
+    std::string s;
+    for (uint len = 1, i = 0; len <= max_length; len++) {
+      for (uint j = 0; j < length_count[len]; j++, i++) {
+        if (s.size()) s += ",";
+        s += "{" + std::to_string(symbols[i]) + ":" + std::to_string(len) +
+             "}";
+      }
+    }
+    return s;
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const {
+    return sizeof(max_length) + sizeof(lookup_bits) +
+           symbols.measure_memory() + length_count.measure_memory() +
+           table.measure_memory();
+  }
+
+ private:
+  // length of the longest code
+  uint max_length;
+  // bits resolved by the lookup table
+  uint lookup_bits;
+  // labels sorted by (code length, label)
+  FixedSizeArray symbols;
+  // number of codes of each length
+  FixedSizeArray length_count;
+  /*
+    indexed by the next lookup_bits bits of the stream (first bit on the least
+    significant position), holds {symbol index, code length}, or 0 when the
+    code is longer than lookup_bits
+  */
+  FixedSizeArray table;
+
+  static void get_code_lengths(const FrequencyContainer& freq,
+                               std::vector<uint>& lengths) {
+    CodeContainer tree_codes;
+    delete HuffmanTree::get(freq, tree_codes);
+    lengths.resize(freq.size());
+    for (uint i = 0; i < freq.size(); i++) {
+      lengths[i] = tree_codes[freq[i].first].second;
+    }
+  }
+
+  /*
+    Make every code fit in kMaxCodeLength bits, keeping the Kraft sum valid:
+    the longer codes are cut, and then the deepest shorter codes are pushed
+    one level down until the lengths describe a prefix code again.
+  */
+  static void limit_code_lengths(std::vector<uint>& lengths) {
+    uint longest = *std::max_element(lengths.begin(), lengths.end());
+    if (longest <= kMaxCodeLength) return;
+
+    std::vector<uint> count(longest + 1, 0);
+    for (uint len : lengths) count[len]++;
+    for (uint len = kMaxCodeLength + 1; len <= longest; len++) {
+      count[kMaxCodeLength] += count[len];
+      count[len] = 0;
+    }
+    // Kraft sum in units of 2^-kMaxCodeLength
+    uint64_t total = 0;
+    for (uint len = 1; len <= kMaxCodeLength; len++) {
+      total += uint64_t(count[len]) << (kMaxCodeLength - len);
+    }
+    for (; total > (uint64_t(1) << kMaxCodeLength); total--) {
+      count[kMaxCodeLength]--;
+      for (uint len = kMaxCodeLength - 1; len > 0; len--) {
+        if (count[len]) {
+          count[len]--;
+          count[len + 1] += 2;
+          break;
+        }
+      }
+    }
+
+    // the shortest codes still go to the most frequent labels
+    std::vector<uint> order(lengths.size());
+    for (uint i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&lengths](uint a, uint b) {
+                       return lengths[a] < lengths[b];
+                     });
+    for (uint len = 1, i = 0; len <= kMaxCodeLength; len++) {
+      for (uint j = 0; j < count[len]; j++) lengths[order[i++]] = len;
+    }
+  }
+
+  /*
+    The table never has more entries than twice the number of labels, so small
+    alphabets keep a small table.
+  */
+  void build_table(const std::vector<uint>& lengths,
+                   const std::vector<uint>& order) {
+    const uint leaves = order.size();
+    lookup_bits = std::min(kLookupBits, max_length);
+    lookup_bits = std::min(lookup_bits, 1 + BitmaskUtility::int_log(leaves));
+    table.assign(1 << lookup_bits, 0,
+                 1 + BitmaskUtility::int_log(leaves) + kLengthBitSize);
+
+    uint code = 0;
+    for (uint i = 0; i < leaves; i++) {
+      uint len = lengths[order[i]];
+      if (i) code = (code + 1) << (len - lengths[order[i - 1]]);
+      if (len > lookup_bits) break;
+      uint reversed = reverse_code(code, len);
+      for (uint j = 0; j < (1u << (lookup_bits - len)); j++) {
+        table.write(reversed | (j << len), (i << kLengthBitSize) | len);
+      }
+    }
+  }
+
+  /*
+    canonical decoding of the code at the beginning of window, which holds the
+    next n_bits bits of the stream (LSB first), setting len to its length
+  */
+  uint decode_slow(uint window, uint n_bits, uint& len) const {
+    uint code = 0, first = 0, index = 0;
+    for (len = 1; len <= max_length && len <= n_bits; len++) {
+      code |= 1 & (window >> (len - 1));
+      uint count = length_count[len];
+      if (code < first + count) {
+        return symbols[index + code - first];
+      }
+      index += count;
+      first = (first + count) << 1;
+      code <<= 1;
+    }
+    throw std::runtime_error("Decoding failed, invalid huffman code.");
+  }
+
+  static uint reverse_code(uint code, uint code_size) {
+    uint new_code = 0;
+    for (uint i = 0; i < code_size; i++) {
+      new_code = (new_code << 1) | (1 & (code >> i));
+    }
+    return new_code;
+  }
+};
+
 }  // namespace lib
 }  // namespace compact
\ No newline at end of file
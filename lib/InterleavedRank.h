@@ -0,0 +1,242 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "lib/Array.h"
+#include "lib/utils/BitmaskUtility.h"
+
+namespace compact {
+namespace lib {
+
+/*
+  Bit stream on 64-bit words with the rank counters interleaved with the bits.
+
+  The bits are split in blocks of 512 bits (8 words), and each block is stored
+  right after a header word:
+  - bits [0, 32): number of 1s before the block
+  - bits [32, 59): three 9-bit counters, number of 1s on the first 1, 2 and 3
+    128-bit sub-blocks of the block
+
+  A rank reads the header and at most two of the words right after it, so it
+  usually stays on a single cache line.
+*/
+class InterleavedBitArray : public Array {
+ public:
+  using Word = uint64_t;
+  using Mask = WordBitmaskUtility<Word>;
+
+  // sizes measured in bits
+  static constexpr uint kCellSize = Mask::kWordSize;
+  static constexpr uint kBlockSize = 512;
+  static constexpr uint kSubBlockSize = 128;
+  static constexpr uint kSubCounterBitSize = 9;
+  static constexpr uint kAbsoluteCounterBitSize = 32;
+  static constexpr uint kWordsPerBlock = kBlockSize / kCellSize;
+  static constexpr uint kWordsPerSubBlock = kSubBlockSize / kCellSize;
+  static constexpr uint kSubBlocksPerBlock = kBlockSize / kSubBlockSize;
+  // data words plus the header
+  static constexpr uint kCellsPerBlock = kWordsPerBlock + 1;
+
+  InterleavedBitArray() : sz(0), total_rank(0), cells() {}
+
+  InterleavedBitArray(uint n) : InterleavedBitArray() { resize(n); }
+
+  InterleavedBitArray(const std::vector<uint>& values)
+      : InterleavedBitArray() {
+    reset(values);
+  }
+
+  InterleavedBitArray(const std::initializer_list<uint>& values)
+      : InterleavedBitArray(std::vector<uint>(values)) {}
+
+  uint size() const override { return sz; }
+
+  void resize(uint n) {
+    sz = n;
+    total_rank = 0;
+    cells.assign(get_block(n + kBlockSize - 1) * kCellsPerBlock, 0);
+  }
+
+  template <typename ArrayType>
+  void reset(const ArrayType& values) {
+    resize(values.size());
+    for (uint i = 0; i < values.size(); i++) {
+      write(i, values[i]);
+    }
+  }
+
+  void assign(uint n, uint val) {
+    resize(n);
+    if (!(val & 1)) return;
+    for (uint w = 0; w < word_count(); w++) {
+      uint bits = std::min(kCellSize, n - w * kCellSize);
+      cells[get_cell(w)] = Mask::get_full_ones(bits);
+    }
+  }
+
+  uint read(uint idx) const override {
+    check_index(idx);
+    return 1 & (get_word(idx / kCellSize) >> (idx % kCellSize));
+  }
+
+  void write(uint idx, uint val) override {
+    check_index(idx);
+    uint cell = get_cell(idx / kCellSize);
+    Word bit = Word(1) << (idx % kCellSize);
+    cells[cell] = (val & 1) ? (cells[cell] | bit) : (cells[cell] & ~bit);
+  }
+
+  // read bits [startBit, endBit] (at most kCellSize of them), LSB first
+  Word read_interval(uint startBit, uint endBit) const {
+    if (startBit > endBit || endBit - startBit + 1 > kCellSize ||
+        endBit >= sz) {
+      throw std::runtime_error(
+          "Invalid bit interval! Interval should fit in a word len");
+    }
+    uint start_word = startBit / kCellSize;
+    uint end_word = endBit / kCellSize;
+    uint offset = startBit % kCellSize;
+    Word result = get_word(start_word) >> offset;
+    if (start_word != end_word) {
+      result |= get_word(end_word) << (kCellSize - offset);
+    }
+    return result & Mask::get_full_ones(endBit - startBit + 1);
+  }
+
+  // number of 64-bit words holding bits of the stream
+  uint word_count() const { return (sz + kCellSize - 1) / kCellSize; }
+
+  Word get_word(uint w) const { return cells[get_cell(w)]; }
+
+  /*
+    Fill the block headers going word by word over the stream. Must be called
+    again after any write.
+  */
+  void build() {
+    uint sum = 0;
+    for (uint b = 0; b < block_count(); b++) {
+      uint base = b * kCellsPerBlock;
+      Word header = sum;
+      uint in_block = 0;
+      for (uint w = 0; w < kWordsPerBlock; w++) {
+        if (w && !(w % kWordsPerSubBlock)) {
+          header |= Word(in_block) << get_sub_counter_shift(
+                        w / kWordsPerSubBlock);
+        }
+        in_block += Mask::popcount(cells[base + 1 + w]);
+      }
+      cells[base] = header;
+      sum += in_block;
+    }
+    total_rank = sum;
+  }
+
+  // number of 1s on the interval [0, pos)
+  uint rank(uint pos) const {
+    if (pos >= sz) return total_rank;
+    uint block = get_block(pos);
+    uint base = block * kCellsPerBlock;
+    uint result = rank_block(block) +
+                  rank_sub_block(block, (pos % kBlockSize) / kSubBlockSize);
+    uint word = (pos % kBlockSize) / kCellSize;
+    if (word % kWordsPerSubBlock) {
+      result += Mask::popcount(cells[base + word]);
+    }
+    uint offset = pos % kCellSize;
+    if (offset) {
+      result += Mask::popcount(cells[base + 1 + word] &
+                               Mask::get_full_ones(offset));
+    }
+    return result;
+  }
+
+  static uint get_block(uint i) { return i / kBlockSize; }
+
+  uint block_count() const { return cells.size() / kCellsPerBlock; }
+
+  // number of 1s before block b
+  uint rank_block(uint b) const {
+    return cells[b * kCellsPerBlock] &
+           Mask::get_full_ones(kAbsoluteCounterBitSize);
+  }
+
+  // number of 1s on block b before its sub-block (0 <= sub_block < 4)
+  uint rank_sub_block(uint b, uint sub_block) const {
+    if (!sub_block) return 0;
+    return (cells[b * kCellsPerBlock] >> get_sub_counter_shift(sub_block)) &
+           Mask::get_full_ones(kSubCounterBitSize);
+  }
+
+  std::string to_string() const {
+    std::string str("[");
+    for (uint i = 0; i < size(); i++) {
+      if (i) str += ",";
+      str += std::to_string(read(i));
+    }
+    return str + "]";
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const override {
+    return sizeof(sz) + sizeof(total_rank) + cells.size() * sizeof(Word);
+  }
+
+ private:
+  uint sz;
+  uint total_rank;
+  // headers and data words, one block after the other
+  std::vector<Word> cells;
+
+  // position on the header of the counter for the given sub-block (>= 1)
+  static constexpr uint get_sub_counter_shift(uint sub_block) {
+    return kAbsoluteCounterBitSize + (sub_block - 1) * kSubCounterBitSize;
+  }
+
+  // position on cells of the w-th word of the stream
+  static uint get_cell(uint w) {
+    return (w / kWordsPerBlock) * kCellsPerBlock + 1 + w % kWordsPerBlock;
+  }
+
+  void check_index(uint idx) const {
+    if (kCheckedAccess && idx >= sz) {
+      throw std::runtime_error(
+          "Index " + std::to_string(idx) +
+          " is out of bounds! Array size is: " + std::to_string(sz));
+    }
+  }
+};
+
+/*
+  Rank manager over an InterleavedBitArray, with the same interface as
+  JacobsonRank so that BitVector can use either of them. The counters live
+  inside the bit stream itself.
+*/
+class InterleavedRank {
+ public:
+  InterleavedRank() : bit_stream_ptr(NULL) {}
+
+  InterleavedRank(InterleavedBitArray& bits) { reset(bits); }
+
+  void reset(InterleavedBitArray& bits) { bit_stream_ptr = &bits; }
+
+  void build() {
+    assert(bit_stream_ptr != NULL);
+    bit_stream_ptr->build();
+  }
+
+  uint rank(uint pos) const { return bit_stream_ptr->rank(pos); }
+
+  // measure memory used in bytes. The counters are accounted on the stream
+  uint measure_memory() const { return 0; }
+
+ private:
+  InterleavedBitArray* bit_stream_ptr;
+};
+
+}  // namespace lib
+}  // namespace compact
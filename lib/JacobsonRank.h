@@ -8,6 +8,7 @@
 #include "glog/logging.h"
 #include "lib/Array.h"
 #include "lib/BitArray.h"
+#include "lib/FixedWidthArray.h"
 
 namespace compact {
 namespace lib {
@@ -43,7 +44,8 @@ class JacobsonRank {
     uint in_small_block_mask = bit_stream_ptr->read_interval(
         get_start_of_small_block(small_block_idx), pos);
 
-    return big_block_rank[big_block_idx] + small_block_rank[small_block_idx] +
+    return big_block_rank.get(big_block_idx) +
+           small_block_rank.get(small_block_idx) +
            BitmaskUtility::popcount(in_small_block_mask) -
            (*bit_stream_ptr)[pos];
   }
@@ -61,8 +63,8 @@ class JacobsonRank {
   uint total_rank;
   uint big_block_size;
   uint small_block_size;
-  FixedSizeArray big_block_rank;
-  FixedSizeArray small_block_rank;
+  DynamicWidthArray big_block_rank;
+  DynamicWidthArray small_block_rank;
   BitArrayType* bit_stream_ptr;
 
   void build_blocks() {
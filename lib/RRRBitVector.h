@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "lib/Array.h"
+#include "lib/BitArray.h"
+#include "lib/BitStream.h"
+#include "lib/FixedWidthArray.h"
+#include "lib/utils/AccessPolicy.h"
+#include "lib/utils/BitmaskUtility.h"
+
+namespace compact {
+namespace lib {
+
+/*
+  Binomial coefficients C(n, k) for n, k <= B, and the number of bits needed
+  to tell apart the C(B, c) blocks of B bits having c ones.
+*/
+template <uint B>
+struct RRRTables {
+  uint binomial[B + 1][B + 1];
+  uint offset_bits[B + 1];
+
+  constexpr RRRTables() : binomial(), offset_bits() {
+    for (uint n = 0; n <= B; n++) {
+      binomial[n][0] = 1;
+      for (uint k = 1; k <= n; k++) {
+        binomial[n][k] = binomial[n - 1][k - 1] + binomial[n - 1][k];
+      }
+    }
+    for (uint c = 0; c <= B; c++) {
+      while ((1u << offset_bits[c]) < binomial[B][c]) offset_bits[c]++;
+    }
+  }
+};
+
+/*
+  Entropy-compressed bitvector (Raman, Raman and Rao) with rank, select and
+  access.
+
+  The bits are split in blocks of kBlockSize bits, each stored as its class,
+  the number of ones on it (4 bits), plus its offset, the index of the block
+  among the C(kBlockSize, class) blocks of that class (up to 13 bits, none
+  for empty and full blocks). The rank and the position of the next offset
+  are sampled every kSampleRate blocks.
+
+  Sparse or clustered bit streams take close to their zero-order entropy,
+  at the cost of scanning up to kSampleRate classes and decoding a block on
+  every query.
+*/
+class RRRBitVector : public Array {
+ public:
+  // bits per block
+  static constexpr uint kBlockSize = 15;
+  // blocks per rank and offset sample
+  static constexpr uint kSampleRate = 32;
+
+  RRRBitVector() : sz(0), total_rank(0) {}
+
+  RRRBitVector(const std::vector<uint>& values) : RRRBitVector() {
+    reset(values);
+  }
+
+  RRRBitVector(const std::initializer_list<uint>& values)
+      : RRRBitVector(std::vector<uint>(values)) {}
+
+  template <typename ArrayType>
+  void reset(const ArrayType& values) {
+    sz = values.size();
+    uint n_blocks = (sz + kBlockSize - 1) / kBlockSize;
+    classes.resize(n_blocks);
+    total_rank = 0;
+    uint offsets_size = 0;
+    for (uint b = 0; b < n_blocks; b++) {
+      uint c = BitmaskUtility::popcount(get_block_bits(values, b));
+      classes.set(b, c);
+      total_rank += c;
+      offsets_size += kTables.offset_bits[c];
+    }
+
+    offsets.resize(offsets_size);
+    uint n_samples = (n_blocks + kSampleRate - 1) / kSampleRate;
+    rank_samples.resize(n_samples, 1 + BitmaskUtility::int_log(sz));
+    offset_samples.resize(n_samples,
+                          1 + BitmaskUtility::int_log(offsets_size));
+    BitWriter writer(offsets);
+    uint rank = 0;
+    for (uint b = 0; b < n_blocks; b++) {
+      if (b % kSampleRate == 0) {
+        rank_samples.set(b / kSampleRate, rank);
+        offset_samples.set(b / kSampleRate, writer.position());
+      }
+      uint c = classes.get(b);
+      writer.write(encode(get_block_bits(values, b)), kTables.offset_bits[c]);
+      rank += c;
+    }
+    writer.flush();
+  }
+
+  uint size() const override { return sz; }
+
+  uint read(uint idx) const override {
+    if (kCheckedAccess && idx >= sz) {
+      throw std::runtime_error(
+          "Read failed! Index " + std::to_string(idx) +
+          " is out of bounds! Array size is: " + std::to_string(sz));
+    }
+    uint block = idx / kBlockSize, offset_pos;
+    locate(block, offset_pos);
+    return 1 & (decode(classes.get(block), offset_pos) >> (idx % kBlockSize));
+  }
+
+  void write(uint idx, uint val) override {
+    throw std::runtime_error("RRRBitVector is a read-only array!");
+  }
+
+  // number of bits equal to bit_value on positions [0, pos)
+  uint rank(uint pos, uint bit_value = 1) const {
+    bit_value %= 2;
+    uint rank1 = total_rank;
+    if (pos < sz) {
+      uint block = pos / kBlockSize, offset_pos;
+      rank1 = locate(block, offset_pos);
+      uint bits = decode(classes.get(block), offset_pos);
+      rank1 += BitmaskUtility::popcount(
+          bits & BitmaskUtility::get_full_ones(pos % kBlockSize));
+    }
+    return bit_value ? rank1 : pos - rank1;
+  }
+
+  // position of the idx-th (0-indexed) bit equal to bit_value, or size()
+  uint select(uint idx, uint bit_value = 1) const {
+    bit_value %= 2;
+    uint total = bit_value ? total_rank : sz - total_rank;
+    if (idx >= total) return sz;
+
+    // last sample with at most idx bits equal to bit_value before it
+    uint low = 0, high = rank_samples.size() - 1;
+    while (low < high) {
+      uint mid = low + (high - low + 1) / 2;
+      if (get_sample_rank(mid, bit_value) <= idx) {
+        low = mid;
+      } else {
+        high = mid - 1;
+      }
+    }
+    idx -= get_sample_rank(low, bit_value);
+    uint block = low * kSampleRate;
+    uint offset_pos = offset_samples.get(low);
+    for (;; block++) {
+      uint c = classes.get(block);
+      uint count = bit_value ? c : kBlockSize - c;
+      if (idx < count) break;
+      idx -= count;
+      offset_pos += kTables.offset_bits[c];
+    }
+    uint bits = decode(classes.get(block), offset_pos);
+    if (!bit_value) bits = ~bits & BitmaskUtility::get_full_ones(kBlockSize);
+    return block * kBlockSize + WordBitmaskUtility<uint>::select(bits, idx);
+  }
+
+  std::string to_string() const {
+    std::string str("[");
+    for (uint i = 0; i < sz; i++) {
+      if (i) str += ",";
+      str += std::to_string(read(i));
+    }
+    return str + "]";
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const override {
+    return sizeof(sz) + sizeof(total_rank) + classes.measure_memory() +
+           offsets.measure_memory() + rank_samples.measure_memory() +
+           offset_samples.measure_memory();
+  }
+
+ private:
+  static constexpr RRRTables<kBlockSize> kTables = RRRTables<kBlockSize>();
+
+  uint sz;
+  uint total_rank;
+  // number of ones of each block
+  FixedWidthArray<4> classes;
+  // offsets of the blocks, each one using the bits its class needs
+  BitArray offsets;
+  // rank and offsets position before the first block of each sample
+  DynamicWidthArray rank_samples;
+  DynamicWidthArray offset_samples;
+
+  template <typename ArrayType>
+  static uint get_block_bits(const ArrayType& values, uint block) {
+    uint start = block * kBlockSize;
+    uint end = std::min(start + kBlockSize, uint(values.size()));
+    uint bits = 0;
+    for (uint i = start; i < end; i++) bits |= (values[i] & 1) << (i - start);
+    return bits;
+  }
+
+  uint get_sample_rank(uint sample, uint bit_value) const {
+    uint rank1 = rank_samples.get(sample);
+    return bit_value ? rank1 : sample * kSampleRate * kBlockSize - rank1;
+  }
+
+  /*
+    Rank before the given block, also setting offset_pos to the position of
+    the offset of the block
+  */
+  uint locate(uint block, uint& offset_pos) const {
+    uint sample = block / kSampleRate;
+    uint rank = rank_samples.get(sample);
+    offset_pos = offset_samples.get(sample);
+    for (uint b = sample * kSampleRate; b < block; b++) {
+      uint c = classes.get(b);
+      rank += c;
+      offset_pos += kTables.offset_bits[c];
+    }
+    return rank;
+  }
+
+  // bits of the block of class c whose offset starts at offset_pos
+  uint decode(uint c, uint offset_pos) const {
+    uint len = kTables.offset_bits[c];
+    uint offset = len ? offsets.read_interval(offset_pos, offset_pos + len - 1)
+                      : 0;
+    uint bits = 0;
+    for (uint j = kBlockSize; c > 0;) {
+      j--;
+      if (offset >= kTables.binomial[j][c]) {
+        offset -= kTables.binomial[j][c];
+        bits |= 1u << j;
+        c--;
+      }
+    }
+    return bits;
+  }
+
+  /*
+    Index of the block among the ones with the same number of ones: the sum
+    of C(p_k, k) for the positions p_1 < ... < p_c of its ones.
+  */
+  static uint encode(uint bits) {
+    uint offset = 0;
+    for (uint k = 1; bits; k++) {
+      offset += kTables.binomial[BitmaskUtility::ctz(bits)][k];
+      bits &= bits - 1;
+    }
+    return offset;
+  }
+};
+
+}  // namespace lib
+}  // namespace compact
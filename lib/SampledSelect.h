@@ -0,0 +1,135 @@
+#pragma once
+
+#include <assert.h>
+
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "lib/FixedSizeArray.h"
+#include "lib/InterleavedRank.h"
+#include "lib/utils/BitmaskUtility.h"
+
+namespace compact {
+namespace lib {
+
+/*
+  Select over the rank directory of an InterleavedBitArray.
+
+  Stores the position of every kSampleRate-th bit equal to bit_value. A query
+  binary searches the block headers between two consecutive samples, then the
+  sub-block counters, and finishes with an in-word select.
+*/
+class SampledSelect {
+  using Word = InterleavedBitArray::Word;
+  using Mask = InterleavedBitArray::Mask;
+
+ public:
+  // one sample every kSampleRate bits equal to bit_value
+  static constexpr uint kSampleRate = 512;
+
+  SampledSelect() : bit_value(1), total_rank(0), bit_stream_ptr(NULL) {}
+
+  SampledSelect(InterleavedBitArray& bits, uint bit_val = 1)
+      : SampledSelect() {
+    bit_stream_ptr = &bits;
+    bit_value = bit_val;
+  }
+
+  /*
+    Expects the rank directory of the bit stream to be already built
+  */
+  void build() {
+    assert(bit_stream_ptr != NULL);
+    uint n = bit_stream_ptr->size();
+    std::vector<uint> positions;
+    uint next_sample = 0;
+    total_rank = 0;
+    for (uint w = 0; w < bit_stream_ptr->word_count(); w++) {
+      Word word = get_weighted_word(w);
+      uint count = Mask::popcount(word);
+      while (next_sample < total_rank + count) {
+        positions.push_back(w * Mask::kWordSize +
+                            Mask::select(word, next_sample - total_rank));
+        next_sample += kSampleRate;
+      }
+      total_rank += count;
+    }
+    samples.reset(positions, BitmaskUtility::int_log(n) + 1);
+  }
+
+  uint select(uint idx) const {
+    uint n = bit_stream_ptr->size();
+    if (idx >= total_rank) return n;
+
+    // find the last block starting with less than idx+1 weighted bits
+    uint sample = idx / kSampleRate;
+    uint low = InterleavedBitArray::get_block(samples[sample]);
+    uint high = sample + 1 < samples.size()
+                    ? InterleavedBitArray::get_block(samples[sample + 1])
+                    : bit_stream_ptr->block_count() - 1;
+    while (low < high) {
+      uint mid = low + (high - low + 1) / 2;
+      if (rank_block(mid) <= idx) {
+        low = mid;
+      } else {
+        high = mid - 1;
+      }
+    }
+    idx -= rank_block(low);
+
+    uint sub_block = InterleavedBitArray::kSubBlocksPerBlock - 1;
+    while (sub_block && rank_sub_block(low, sub_block) > idx) sub_block--;
+    idx -= rank_sub_block(low, sub_block);
+
+    uint word = low * InterleavedBitArray::kWordsPerBlock +
+                sub_block * InterleavedBitArray::kWordsPerSubBlock;
+    // a sub-block has two words, the answer is on one of them
+    uint count = Mask::popcount(get_weighted_word(word));
+    if (count <= idx) {
+      idx -= count;
+      word++;
+    }
+    return word * Mask::kWordSize +
+           Mask::select(get_weighted_word(word), idx);
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const {
+    return sizeof(bit_value) + sizeof(total_rank) + samples.measure_memory();
+  }
+
+ private:
+  // which kind of bit this select is about: 0s or 1s
+  uint bit_value;
+  // amount of bits equals to bit_value on the bit_stream
+  uint total_rank;
+  // position of every kSampleRate-th bit equal to bit_value
+  FixedSizeArray samples;
+  InterleavedBitArray* bit_stream_ptr;
+
+  // word w with the bits equal to bit_value active
+  Word get_weighted_word(uint w) const {
+    Word word = bit_stream_ptr->get_word(w);
+    if (bit_value) return word;
+    uint valid = std::min(Mask::kWordSize,
+                          bit_stream_ptr->size() - w * Mask::kWordSize);
+    return ~word & Mask::get_full_ones(valid);
+  }
+
+  // number of bits equal to bit_value before block b
+  uint rank_block(uint b) const {
+    uint rank1 = bit_stream_ptr->rank_block(b);
+    return bit_value ? rank1 : b * InterleavedBitArray::kBlockSize - rank1;
+  }
+
+  // number of bits equal to bit_value on block b before the given sub-block
+  uint rank_sub_block(uint b, uint sub_block) const {
+    uint rank1 = bit_stream_ptr->rank_sub_block(b, sub_block);
+    return bit_value ? rank1
+                     : sub_block * InterleavedBitArray::kSubBlockSize - rank1;
+  }
+};
+
+}  // namespace lib
+}  // namespace compact
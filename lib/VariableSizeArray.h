@@ -2,44 +2,111 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
 #include "glog/logging.h"
 #include "lib/Array.h"
+#include "lib/ArrayCursor.h"
 #include "lib/BitArray.h"
+#include "lib/BitStream.h"
 #include "lib/FixedSizeArray.h"
+#include "lib/utils/BitmaskUtility.h"
+#include "lib/utils/EliasDeltaUtility.h"
 #include "lib/utils/GamaUtility.h"
 
 namespace compact {
 namespace lib {
 
-class VariableSizeArray : public Array {
+/*
+  Read-only array of variable-length codes, the bit position of every
+  sample_rate-th code being sampled. Coder is the utility producing and
+  decoding the codes: GamaUtility for VariableSizeArray and
+  EliasDeltaUtility for DeltaVariableSizeArray.
+*/
+template <typename Coder = GamaUtility>
+class BasicVariableSizeArray : public Array {
  public:
-  VariableSizeArray() : sz(0), bitStream(), offsets() {}
+  // 22 == BitmaskUtility::kWordSize * ln(2)
+  static const uint kDefaultSampleRate = 22;
 
-  ~VariableSizeArray() {}
+  BasicVariableSizeArray(uint sample_rate = kDefaultSampleRate)
+      : sz(0), sample_rate(std::max(1u, sample_rate)), bitStream(), offsets() {}
 
-  VariableSizeArray(const std::vector<uint>& values) { setup(values); }
+  ~BasicVariableSizeArray() {}
 
-  VariableSizeArray(const std::initializer_list<uint>& values)
-      : VariableSizeArray(std::vector<uint>(values)) {}
+  BasicVariableSizeArray(const std::vector<uint>& values,
+                         uint sample_rate = kDefaultSampleRate)
+      : BasicVariableSizeArray(sample_rate) {
+    setup(values);
+  }
+
+  BasicVariableSizeArray(const std::initializer_list<uint>& values)
+      : BasicVariableSizeArray(std::vector<uint>(values)) {}
 
   uint size() const override { return sz; }
 
   uint read(uint idx) const override {
-    if (!is_index_valid(idx)) {
+    if (kCheckedAccess && !is_index_valid(idx)) {
       throw std::runtime_error("Invalid index!");
     }
-    uint b = get_block(idx);
-    uint targetPos = get_position_in_block(idx);
-    uint offset = offsets[b];
-    for (uint i = 0; i < targetPos; i++) {
-      GamaUtility::decode_next(bitStream, offset);
-    }
-    return GamaUtility::decode_next(bitStream, offset);
+    return *cursor(idx);
+  }
+
+  /*
+    Decode the values on positions [l, r), seeking the closest sample only
+    once and decoding the rest sequentially.
+  */
+  void decode_range(uint l, uint r, std::vector<uint>& values) const {
+    values.clear();
+    r = std::min(r, sz);
+    if (l >= r) return;
+    values.reserve(r - l);
+    for (Cursor it = cursor(l); it.index() < r; ++it) values.push_back(*it);
   }
 
+  // forward cursor, decoding each code right after the previous one
+  class Cursor : public ArrayCursor<Cursor> {
+   public:
+    using ArrayCursor<Cursor>::operator++;
+
+    Cursor() : arr(NULL), idx(0), value(0) {}
+
+    Cursor(const BasicVariableSizeArray* arr, uint idx)
+        : arr(arr), idx(idx), value(0) {
+      if (idx >= arr->sz) return;
+      reader = BitReader(arr->bitStream, arr->offsets[arr->get_block(idx)]);
+      for (uint i = arr->get_position_in_block(idx); i > 0; i--) {
+        Coder::decode_next(reader);
+      }
+      value = Coder::decode_next(reader);
+    }
+
+    uint operator*() const { return value; }
+
+    Cursor& operator++() {
+      if (++idx < arr->sz) value = Coder::decode_next(reader);
+      return *this;
+    }
+
+    uint index() const { return idx; }
+
+   private:
+    const BasicVariableSizeArray* arr;
+    uint idx;
+    BitReader reader;
+    // decoded value on position idx
+    uint value;
+  };
+
+  Cursor begin() const { return Cursor(this, 0); }
+
+  Cursor end() const { return Cursor(this, sz); }
+
+  // cursor pointing to position idx
+  Cursor cursor(uint idx) const { return Cursor(this, std::min(idx, sz)); }
+
   // TODO: make this class extend a "ReadableArray" class or s/th like this
   void write(uint idx, uint val) override {
     throw std::runtime_error(
@@ -48,39 +115,45 @@ class VariableSizeArray : public Array {
 
   void reset(const std::vector<uint>& values) { setup(values); }
 
+  uint get_sample_rate() const { return sample_rate; }
+
   // measure memory used in bytes
   uint measure_memory() const override {
-    return sizeof(blockSize) + sizeof(sz) + bitStream.measure_memory() +
+    return sizeof(sample_rate) + sizeof(sz) + bitStream.measure_memory() +
            offsets.measure_memory();
   }
 
  private:
-  // TODO: make this equal to BitmaskUtility::kWordSize * ln(2)
-  static const uint blockSize = 2;  // k
   uint sz;
+  // number of codes between two sampled positions
+  uint sample_rate;
   BitArray bitStream;
   FixedSizeArray offsets;
 
   void setup(const std::vector<uint>& values) {
     sz = values.size();
-    bitStream.reset(GamaUtility::get_array_code(values));
-    offsets.assign(std::ceil(1.0 * sz / blockSize), 0);
+    bitStream.reset(Coder::get_array_code(values));
+    offsets.assign(std::ceil(1.0 * sz / sample_rate), 0,
+                   1 + BitmaskUtility::int_log(bitStream.size()));
 
-    uint offset = 0;
+    BitReader reader(bitStream);
     for (uint i = 0; i < sz; i++) {
-      if ((i % blockSize) == 0) {
-        offsets.write(i / blockSize, offset);
+      if (get_position_in_block(i) == 0) {
+        offsets.write(get_block(i), reader.position());
       }
-      GamaUtility::decode_next(bitStream, offset);
+      Coder::decode_next(reader);
     }
   }
 
-  uint get_block(uint idx) const { return idx / blockSize; }
+  uint get_block(uint idx) const { return idx / sample_rate; }
 
-  uint get_position_in_block(uint idx) const { return idx % blockSize; }
+  uint get_position_in_block(uint idx) const { return idx % sample_rate; }
 
   bool is_index_valid(uint idx) const { return idx >= 0 && idx < sz; }
 };
 
+using VariableSizeArray = BasicVariableSizeArray<GamaUtility>;
+using DeltaVariableSizeArray = BasicVariableSizeArray<EliasDeltaUtility>;
+
 }  // namespace lib
 }  // namespace compact
@@ -8,14 +8,28 @@
 
 #include "glog/logging.h"
 #include "lib/Array.h"
+#include "lib/ArrayCursor.h"
 #include "lib/BitArray.h"
+#include "lib/BitStream.h"
 #include "lib/FixedSizeArray.h"
+#include "lib/FixedWidthArray.h"
 #include "lib/utils/DensePointersUtility.h"
 
 namespace compact {
 namespace lib {
 
 class VariableSizeDenseArray : public Array {
+ private:
+  // 22 == BitmaskUtility::kWordSize * ln(2)
+  static constexpr uint kBlockSize = 22;  // k
+  // 12 = log2(w*w*2), where w = wordSize = 32
+  static constexpr uint kInBlockOffsetsBitSize = 12;
+  static constexpr uint kCellSize = BitArray::kCellSize;
+  // cells spanned by the longest block, kBlockSize codes of up to 31 bits
+  // (plus a start of up to kCellSize - 1 bits into the first cell)
+  static constexpr uint kMaxBlockCells =
+      (2 * (kCellSize - 1) + kBlockSize * (kCellSize - 1)) / kCellSize;
+
  public:
   VariableSizeDenseArray() : sz(0), bitStream() {}
 
@@ -29,7 +43,7 @@ class VariableSizeDenseArray : public Array {
   uint size() const override { return sz; }
 
   uint read(uint idx) const override {
-    if (!is_index_valid(idx)) {
+    if (kCheckedAccess && !is_index_valid(idx)) {
       throw std::runtime_error("Invalid index!");
     }
 
@@ -40,6 +54,68 @@ class VariableSizeDenseArray : public Array {
     return decodedValue - valueOffset;
   }
 
+  /*
+    Decode the values on positions [l, r) a block at a time, see
+    decode_block.
+  */
+  void decode_range(uint l, uint r, std::vector<uint>& values) const {
+    values.clear();
+    r = std::min(r, sz);
+    if (l >= r) return;
+    values.resize(r - l);
+    uint block_values[kBlockSize];
+    for (uint block = get_block(l); block * kBlockSize < r; block++) {
+      uint first = block * kBlockSize;
+      uint count = decode_block(block, block_values);
+      uint from = std::max(first, l), to = std::min(first + count, r);
+      std::copy(block_values + (from - first), block_values + (to - first),
+                values.begin() + (from - l));
+    }
+  }
+
+  // forward cursor, decoding a whole block whenever it enters one
+  class Cursor : public ArrayCursor<Cursor> {
+   public:
+    using ArrayCursor<Cursor>::operator++;
+
+    Cursor() : arr(NULL), idx(0), pos(0), count(0) {}
+
+    Cursor(const VariableSizeDenseArray* arr, uint idx)
+        : arr(arr), idx(idx), pos(0), count(0) {
+      if (idx >= arr->sz) return;
+      count = arr->decode_block(get_block(idx), values);
+      pos = get_position_in_block(idx);
+    }
+
+    uint operator*() const { return values[pos]; }
+
+    Cursor& operator++() {
+      ++idx;
+      if (++pos == count && idx < arr->sz) {
+        count = arr->decode_block(get_block(idx), values);
+        pos = 0;
+      }
+      return *this;
+    }
+
+    uint index() const { return idx; }
+
+   private:
+    const VariableSizeDenseArray* arr;
+    uint idx;
+    // position of idx on its block, and number of values on the block
+    uint pos;
+    uint count;
+    uint values[kBlockSize];
+  };
+
+  Cursor begin() const { return Cursor(this, 0); }
+
+  Cursor end() const { return Cursor(this, sz); }
+
+  // cursor pointing to position idx
+  Cursor cursor(uint idx) const { return Cursor(this, std::min(idx, sz)); }
+
   // TODO: make this class extend a "ReadableArray" class or s/th like this
   void write(uint idx, uint val) override {
     throw std::runtime_error(
@@ -56,15 +132,11 @@ class VariableSizeDenseArray : public Array {
   }
 
  private:
-  // 22 == BitmaskUtility::kWordSize * ln(2)
-  static const uint kBlockSize = 22;  // k
-  // 12 = log2(w*w*2), where w = wordSize = 32
-  static const uint kInBlockOffsetsBitSize = 12;
   uint sz;
   int valueOffset;
   BitArray bitStream;
-  FixedSizeArray offsets;
-  FixedSizeArray inBlockOffsets;
+  FixedWidthArray<kMaxFixedWidth> offsets;
+  FixedWidthArray<kInBlockOffsetsBitSize> inBlockOffsets;
 
   void setup(std::vector<uint> values) {
     sz = values.size();
@@ -74,8 +146,8 @@ class VariableSizeDenseArray : public Array {
     valueOffset = 1 - minVal;
     shift_values(values);
     bitStream.reset(DensePointersUtility::get_array_code(values));
-    offsets.assign(std::ceil(1.0 * sz / kBlockSize), 0);
-    inBlockOffsets.assign(sz, 0, kInBlockOffsetsBitSize);
+    offsets.resize(std::ceil(1.0 * sz / kBlockSize));
+    inBlockOffsets.resize(sz);
 
     uint offset = 0;
     uint inBlockOffset = 0;
@@ -98,7 +170,47 @@ class VariableSizeDenseArray : public Array {
 
   uint get_offset(uint idx) const {
     if (idx == sz) return bitStream.size();
-    return offsets[get_block(idx)] + inBlockOffsets[idx];
+    return offsets.get(get_block(idx)) + inBlockOffsets.get(idx);
+  }
+
+  /*
+    Write the values of the given block to out, returning how many there
+    are. The offset of the block is read once, and the position and length
+    of every code come from the in-block offsets, so each code is extracted
+    on its own from a local copy of the cells of the block: two cells, a
+    shift and a mask, with no dependency between consecutive codes.
+  */
+  uint decode_block(uint block, uint* out) const {
+    uint first = block * kBlockSize;
+    uint count = std::min(kBlockSize, sz - first);
+    uint base = offsets.get(block);
+    uint last = first + count;
+    uint block_end = last == sz ? bitStream.size() : offsets.get(block + 1);
+
+    // code k takes bits [starts[k], starts[k + 1]) of the block
+    uint starts[kBlockSize + 1];
+    for (uint k = 0; k < count; k++) {
+      starts[k] = inBlockOffsets.get(first + k);
+    }
+    starts[count] = block_end - base;
+
+    // cells covering the block, plus a zero one so every code reads two
+    uint cells[kMaxBlockCells + 1];
+    uint first_cell = base / kCellSize, shift = base % kCellSize;
+    uint n_cells = (shift + starts[count] + kCellSize - 1) / kCellSize;
+    for (uint c = 0; c < n_cells; c++) {
+      cells[c] = bitStream.read_cell(first_cell + c);
+    }
+    cells[n_cells] = 0;
+
+    for (uint k = 0; k < count; k++) {
+      uint pos = shift + starts[k], len = starts[k + 1] - starts[k];
+      uint64_t window = (uint64_t(cells[pos / kCellSize + 1]) << kCellSize) |
+                        cells[pos / kCellSize];
+      uint code = uint(window >> (pos % kCellSize)) & ((1u << len) - 1);
+      out[k] = ((1u << len) | code) - valueOffset;
+    }
+    return count;
   }
 
   static uint get_block(uint idx) { return idx / kBlockSize; }
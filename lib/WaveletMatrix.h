@@ -0,0 +1,503 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "glog/logging.h"
+#include "lib/BitArray.h"
+#include "lib/BitVector.h"
+#include "lib/FixedSizeArray.h"
+#include "lib/WaveletTreeInterface.h"
+#include "lib/utils/BitmaskUtility.h"
+#include "lib/utils/Utils.h"
+
+namespace compact {
+namespace lib {
+
+/*
+  Pointer-free alternative to the WaveletTree: one bitvector per level of the
+  binary representation of the values (shifted by the smallest one), from the
+  most significant bit to the least significant one.
+
+  On each level the sequence is stably partitioned, values with a 0 on that
+  bit first, so the nodes of a level are contiguous ranges of a single
+  bitvector and going down only needs a rank and the number of zeros of the
+  level.
+
+  Use WaveletMatrix for 32-bit cell bitvectors and WaveletMatrix64 for 64-bit
+  cell ones. AdaptiveWaveletMatrix64 compresses the levels that are sparse
+  (see BasicAdaptiveBitVector).
+*/
+template <typename BitVectorType = BitVector>
+class BasicWaveletMatrix : public WaveletTreeInterface {
+ public:
+  BasicWaveletMatrix() : sz(0), low(0), high(0), height(0) {}
+
+  BasicWaveletMatrix(const std::vector<uint>& values) : BasicWaveletMatrix() {
+    reset(values);
+  }
+
+  BasicWaveletMatrix(const std::initializer_list<uint>& values)
+      : BasicWaveletMatrix(std::vector<uint>(values)) {}
+
+  void reset(const std::vector<uint>& values) override {
+    reset(std::vector<uint>(values));
+  }
+
+  /*
+    Build level by level using values as the working buffer, so the only
+    extra memory is a single scratch array of the same size.
+
+    With more than one thread, each level is partitioned in parallel chunks,
+    and the rank/select structures of a level are built on their own thread
+    while the next levels are partitioned.
+  */
+  void reset(std::vector<uint>&& values, uint threads = 1) {
+    sz = values.size();
+    levels.clear();
+    zeros.resize(0);
+    low = high = height = 0;
+    if (!sz) return;
+
+    threads = std::max(1u, threads);
+    low = *std::min_element(values.begin(), values.end());
+    high = *std::max_element(values.begin(), values.end());
+    height = low == high ? 0 : 1 + BitmaskUtility::int_log(high - low);
+    // constructed in place, bitvectors must not be copied around
+    levels = std::vector<BitVectorType>(height);
+    zeros.resize(height);
+
+    // chunks are aligned to 64 bits, so no two threads write the same cell
+    uint chunk = (sz + threads - 1) / threads;
+    chunk = (chunk + kChunkAlignment - 1) / kChunkAlignment * kChunkAlignment;
+    const uint n_chunks = (sz + chunk - 1) / chunk;
+    std::vector<uint> chunk_zeros(n_chunks);
+
+    std::vector<uint>& curr = values;
+    std::vector<uint> next(sz);
+    for (uint i = 0; i < sz; i++) curr[i] -= low;
+    std::deque<std::thread> builders;
+    for (uint level = 0; level < height; level++) {
+      uint shift = height - level - 1;
+      std::unique_ptr<BitArray> bits(new BitArray(sz));
+      Utils::parallel_for(n_chunks, threads, [&](uint c) {
+        uint n_zeros = 0;
+        for (uint i = c * chunk; i < std::min(sz, (c + 1) * chunk); i++) {
+          uint b = 1 & (curr[i] >> shift);
+          bits->write(i, b);
+          n_zeros += !b;
+        }
+        chunk_zeros[c] = n_zeros;
+      });
+
+      // turn the counters into the first position of the zeros of each chunk
+      uint n_zeros = 0;
+      for (uint c = 0; c < n_chunks; c++) {
+        uint count = chunk_zeros[c];
+        chunk_zeros[c] = n_zeros;
+        n_zeros += count;
+      }
+      Utils::parallel_for(n_chunks, threads, [&](uint c) {
+        uint zero_idx = chunk_zeros[c];
+        uint one_idx = n_zeros + c * chunk - chunk_zeros[c];
+        for (uint i = c * chunk; i < std::min(sz, (c + 1) * chunk); i++) {
+          if (1 & (curr[i] >> shift)) {
+            next[one_idx++] = curr[i];
+          } else {
+            next[zero_idx++] = curr[i];
+          }
+        }
+      });
+      zeros.write(level, n_zeros);
+      curr.swap(next);
+
+      if (threads == 1) {
+        levels[level].reset(*bits);
+        continue;
+      }
+      if (builders.size() + 1 >= threads) {
+        builders.front().join();
+        builders.pop_front();
+      }
+      builders.emplace_back(
+          [this, level](std::unique_ptr<BitArray> level_bits) {
+            levels[level].reset(*level_bits);
+          },
+          std::move(bits));
+    }
+    for (auto& builder : builders) builder.join();
+  }
+
+  uint size() const override { return sz; }
+
+  uint access(uint idx) const override {
+    uint val = 0;
+    for (uint level = 0; level < height; level++) {
+      uint b = levels[level][idx];
+      idx = go_down(level, idx, b);
+      val = (val << 1) | b;
+    }
+    return val + low;
+  }
+
+  // number of occurrences of c on [0, pos)
+  uint rank(uint pos, uint c) const override {
+    if (!check_value(c)) return 0;
+    return count(0, std::min(pos, sz), c - low);
+  }
+
+  // position of the occurrence of c with index pos (0-based)
+  uint select(uint pos, uint c) const override {
+    if (!check_value(c)) return sz;
+    c -= low;
+
+    uint l = 0, r = sz;
+    for (uint level = 0; level < height; level++) {
+      uint b = get_bit(c, level);
+      l = go_down(level, l, b);
+      r = go_down(level, r, b);
+    }
+    if (pos >= r - l) return sz;
+
+    pos += l;
+    for (uint level = height; level-- > 0;) {
+      pos = go_up(level, pos, get_bit(c, level));
+    }
+    return pos;
+  }
+
+  // calculates the frenquency of val in range [l, r]
+  uint range_count(uint l, uint r, uint val) const override {
+    if (!check_value(val) || !check_interval(l, r)) return 0;
+    return count(l, r + 1, val - low);
+  }
+
+  // returns the index of the first number >= val in [l, r]
+  // or r+1 in case there's no number >= val in [l, r]
+  uint range_next_value_pos(uint l, uint r, uint val) const {
+    if (!check_interval(l, r)) return r + 1;
+    if (val <= low) return l;
+    if (val > high) return r + 1;
+    return next_value_pos(0, l, r + 1, val - low);
+  }
+
+  /*
+    range_next_value_pos on the consecutive ranges [bounds[k], bounds[k + 1]),
+    with bounds nondecreasing: positions[k] is the first position of range k
+    with a value >= val, or bounds[k + 1] if there is none.
+
+    All the ranges follow the path of val, so their bounds go down together
+    with one rank per bound and level, shared by adjacent ranges. On the way
+    back up a select is only paid when the answer is not at a known offset of
+    its range, which it is whenever the range starts with a run of the bits
+    the answer came through.
+  */
+  void ranges_next_value_pos(const std::vector<uint>& bounds, uint val,
+                             std::vector<uint>& positions) const {
+    uint n_ranges = bounds.size() < 2 ? 0 : bounds.size() - 1;
+    positions.resize(n_ranges);
+    if (!sz || val > high || val <= low) {
+      uint shift = sz && val <= low ? 0 : 1;
+      for (uint k = 0; k < n_ranges; k++) positions[k] = bounds[k + shift];
+      return;
+    }
+    uint c = val - low, width = n_ranges + 1;
+    // bounds mapped to each level of the path, and the ones before them
+    std::vector<uint> at((height + 1) * width), ones(height * width);
+    std::copy(bounds.begin(), bounds.end(), at.begin());
+    for (uint level = 0; level < height; level++) {
+      const BitVectorType& bitvec = levels[level];
+      const uint* cur = &at[level * width];
+      uint* cur_ones = &ones[level * width];
+      uint* next = &at[(level + 1) * width];
+      uint b = get_bit(c, level);
+      for (uint k = 0; k < width; k++) {
+        cur_ones[k] = k && cur[k] == cur[k - 1] ? cur_ones[k - 1]
+                                                : bitvec.rank(cur[k], 1);
+        next[k] = b ? zeros[level] + cur_ones[k] : cur[k] - cur_ones[k];
+      }
+    }
+
+    // on the leaf every value is c, so the answer is the start of the range,
+    // or its end if it is empty
+    auto leaf = at.begin() + height * width;
+    std::copy(leaf, leaf + n_ranges, positions.begin());
+    for (uint level = height; level-- > 0;) {
+      const BitVectorType& bitvec = levels[level];
+      const uint* cur = &at[level * width];
+      const uint* cur_ones = &ones[level * width];
+      const uint* child = &at[(level + 1) * width];
+      uint b = get_bit(c, level);
+      for (uint k = 0; k < n_ranges; k++) {
+        uint l = cur[k], r = cur[k + 1];
+        uint ones_l = cur_ones[k], ones_r = cur_ones[k + 1];
+        uint idx = positions[k];
+        bool found = idx < child[k + 1];
+        if (b) {
+          positions[k] = found ? go_up(level, idx, 1) : r;
+          continue;
+        }
+        // every element going to the ones is valid, so the answer is the
+        // first one of the range unless a zero from below comes earlier
+        uint pos = l + (idx - child[k]);
+        if (!found) {
+          positions[k] = ones_l < ones_r ? bitvec.select(ones_l, 1) : r;
+        } else if (pos == l || ones_l == ones_r ||
+                   bitvec.rank(pos, 1) == ones_l) {
+          // [l, pos) are all zeros: pos holds either the answer from below
+          // or the first one of the range
+          positions[k] = pos;
+        } else {
+          positions[k] = bitvec.select(ones_l, 1);
+        }
+      }
+    }
+  }
+
+  // returns the value of the first number >= val in [l, r]
+  uint range_next_value(uint l, uint r, uint val) const {
+    uint idx = range_next_value_pos(l, r, val);
+    if (idx > r) {
+      return 0;
+    }
+    return access(idx);
+  }
+
+  // frequencies of each value on [l, r]
+  void range_report(uint l, uint r,
+                    std::unordered_map<uint, uint>& report_container) const {
+    report_container.clear();
+    if (!check_interval(l, r)) return;
+    report(0, l, r + 1, 0, report_container);
+  }
+
+  /*
+    Append to values, in increasing order, the distinct values v <= max_value
+    on [l, r) that either appear an odd number of times on [l, m) or appear
+    at least once on [m, r), with l <= m <= r. Everything is solved in a
+    single traversal that skips the nodes above max_value.
+  */
+  void range_active_values(uint l, uint m, uint r, uint max_value,
+                           std::vector<uint>& values) const {
+    if (l >= r || r > sz || m < l || m > r || max_value < low) return;
+    active_values(0, l, m, r, 0, max_value - low, values);
+  }
+
+  // range [l, r) split at m, with l <= m <= r
+  struct SplitRange {
+    uint l, m, r;
+  };
+
+  /*
+    range_active_values on many ranges in a single traversal: calls f(k, v)
+    for every value v <= max_value active on ranges[k], the values of each
+    range in increasing order. Every node is visited once for all the ranges
+    crossing it, so with ranges sorted by position each level is scanned left
+    to right and the rank of a position shared by consecutive ranges is only
+    computed once.
+  */
+  template <typename Function>
+  void ranges_active_values(const std::vector<SplitRange>& ranges,
+                            uint max_value, const Function& f) const {
+    if (!sz || max_value < low) return;
+    // ranges crossing the node visited on each level of the current path
+    std::vector<std::vector<BatchRange>> path(height + 1);
+    for (uint k = 0; k < ranges.size(); k++) {
+      const SplitRange& q = ranges[k];
+      if (q.l < q.r && q.r <= sz && q.l <= q.m && q.m <= q.r) {
+        path[0].push_back({k, q.l, q.m, q.r, 0, 0, 0});
+      }
+    }
+    batch_active_values(0, 0, max_value - low, path, f);
+  }
+
+  uint operator[](uint idx) const override { return access(idx); }
+
+  std::string to_string() const override {
+    std::string s("WaveletMatrix: [");
+    for (uint i = 0; i < size(); i++) {
+      if (i) s += ",";
+      s += std::to_string(access(i));
+    }
+    s += "]";
+    return s;
+  }
+
+  // measure memory used in bytes
+  uint measure_memory() const override {
+    uint total = sizeof(sz) + sizeof(low) + sizeof(high) + sizeof(height) +
+                 zeros.measure_memory();
+    for (auto& level : levels) total += level.measure_memory();
+    return total;
+  }
+
+ private:
+  // alignment of the chunks built in parallel, measured in bits
+  static const uint kChunkAlignment = 64;
+
+  uint sz;
+  uint low;
+  uint high;
+  // number of levels, bits needed to represent high - low
+  uint height;
+  std::vector<BitVectorType> levels;
+  // number of zeros on each level
+  FixedSizeArray zeros;
+
+  uint get_bit(uint val, uint level) const {
+    return 1 & (val >> (height - level - 1));
+  }
+
+  // position on the level below of the element on position idx of level
+  uint go_down(uint level, uint idx, uint b) const {
+    return b ? zeros[level] + levels[level].rank(idx, 1)
+             : levels[level].rank(idx, 0);
+  }
+
+  // position on level of the element on position idx of the level below
+  uint go_up(uint level, uint idx, uint b) const {
+    return b ? levels[level].select(idx - zeros[level], 1)
+             : levels[level].select(idx, 0);
+  }
+
+  // occurrences of the (shifted) value c on [l, r)
+  uint count(uint l, uint r, uint c) const {
+    for (uint level = 0; level < height; level++) {
+      uint b = get_bit(c, level);
+      l = go_down(level, l, b);
+      r = go_down(level, r, b);
+    }
+    return r - l;
+  }
+
+  /*
+    First position of [l, r) on the given level with a (shifted) value >= c,
+    or r if there is none. Every value on [l, r) shares the bits of c above
+    this level.
+  */
+  uint next_value_pos(uint level, uint l, uint r, uint c) const {
+    if (l >= r || level == height) return l;
+
+    const BitVectorType& bitvec = levels[level];
+    uint ones_l = bitvec.rank(l, 1), ones_r = bitvec.rank(r, 1);
+    if (get_bit(c, level)) {
+      uint child_r = zeros[level] + ones_r;
+      uint idx = next_value_pos(level + 1, zeros[level] + ones_l, child_r, c);
+      return idx == child_r ? r : go_up(level, idx, 1);
+    }
+
+    // every element going to the ones is valid
+    uint ans = ones_l < ones_r ? bitvec.select(ones_l, 1) : r;
+    uint child_r = r - ones_r;
+    uint idx = next_value_pos(level + 1, l - ones_l, child_r, c);
+    if (idx != child_r) ans = std::min(ans, go_up(level, idx, 0));
+    return ans;
+  }
+
+  // add to result the frequencies of the values on [l, r) of the given level
+  void report(uint level, uint l, uint r, uint prefix,
+              std::unordered_map<uint, uint>& result) const {
+    if (l >= r) return;
+    if (level == height) {
+      result[prefix + low] = r - l;
+      return;
+    }
+    uint ones_l = levels[level].rank(l, 1), ones_r = levels[level].rank(r, 1);
+    report(level + 1, l - ones_l, r - ones_r, prefix << 1, result);
+    report(level + 1, zeros[level] + ones_l, zeros[level] + ones_r,
+           (prefix << 1) | 1, result);
+  }
+
+  // recursive step of range_active_values, values shifted by low
+  void active_values(uint level, uint l, uint m, uint r, uint prefix,
+                     uint max_value, std::vector<uint>& values) const {
+    if (l >= r) return;
+    // smallest value on this node
+    if ((uint64_t(prefix) << (height - level)) > max_value) return;
+    if (level == height) {
+      if (((m - l) & 1) || m < r) values.push_back(prefix + low);
+      return;
+    }
+    const BitVectorType& bitvec = levels[level];
+    uint ones_l = bitvec.rank(l, 1), ones_m = bitvec.rank(m, 1),
+         ones_r = bitvec.rank(r, 1);
+    active_values(level + 1, l - ones_l, m - ones_m, r - ones_r, prefix << 1,
+                  max_value, values);
+    active_values(level + 1, zeros[level] + ones_l, zeros[level] + ones_m,
+                  zeros[level] + ones_r, (prefix << 1) | 1, max_value, values);
+  }
+
+  // range of ranges_active_values on a node, with the ones before l, m and r
+  struct BatchRange {
+    uint k, l, m, r;
+    uint ones_l, ones_m, ones_r;
+  };
+
+  // recursive step of ranges_active_values, values shifted by low
+  template <typename Function>
+  void batch_active_values(uint level, uint prefix, uint max_value,
+                           std::vector<std::vector<BatchRange>>& path,
+                           const Function& f) const {
+    std::vector<BatchRange>& node = path[level];
+    if (node.empty()) return;
+    // smallest value on this node
+    if ((uint64_t(prefix) << (height - level)) > max_value) return;
+    if (level == height) {
+      for (const BatchRange& q : node) {
+        if (((q.m - q.l) & 1) || q.m < q.r) f(q.k, prefix + low);
+      }
+      return;
+    }
+
+    const BitVectorType& bitvec = levels[level];
+    uint last_pos = sz + 1, last_ones = 0;
+    auto ones = [&](uint pos) {
+      if (pos != last_pos) {
+        last_pos = pos;
+        last_ones = bitvec.rank(pos, 1);
+      }
+      return last_ones;
+    };
+    for (BatchRange& q : node) {
+      q.ones_l = ones(q.l);
+      q.ones_m = ones(q.m);
+      q.ones_r = ones(q.r);
+    }
+
+    // the children reuse the next level of the path one after the other
+    std::vector<BatchRange>& child = path[level + 1];
+    uint level_zeros = zeros[level];
+    child.clear();
+    for (const BatchRange& q : node) {
+      if (q.l - q.ones_l < q.r - q.ones_r) {
+        child.push_back({q.k, q.l - q.ones_l, q.m - q.ones_m, q.r - q.ones_r,
+                         0, 0, 0});
+      }
+    }
+    batch_active_values(level + 1, prefix << 1, max_value, path, f);
+    child.clear();
+    for (const BatchRange& q : node) {
+      if (q.ones_l < q.ones_r) {
+        child.push_back({q.k, level_zeros + q.ones_l, level_zeros + q.ones_m,
+                         level_zeros + q.ones_r, 0, 0, 0});
+      }
+    }
+    batch_active_values(level + 1, (prefix << 1) | 1, max_value, path, f);
+  }
+
+  bool check_value(uint val) const { return sz && val >= low && val <= high; }
+
+  bool check_interval(uint l, uint r) const { return l <= r && r < sz; }
+};
+
+using WaveletMatrix = BasicWaveletMatrix<BitVector>;
+using WaveletMatrix64 = BasicWaveletMatrix<BitVector64>;
+using AdaptiveWaveletMatrix64 = BasicWaveletMatrix<AdaptiveBitVector64>;
+
+}  // namespace lib
+}  // namespace compact
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "glog/logging.h"
 #include "lib/Array.h"
+#include "lib/ArrayCursor.h"
 #include "lib/BitVector.h"
 #include "lib/WaveletTreeInterface.h"
 #include "lib/utils/Utils.h"
@@ -12,16 +15,20 @@
 namespace compact {
 namespace lib {
 
-class WaveletTreeNode {
+template <typename BitVectorType = BitVector>
+class BasicWaveletTreeNode {
  public:
-  using WaveletTreeNodePointer = WaveletTreeNode*;
+  using WaveletTreeNodePointer = BasicWaveletTreeNode*;
+
+  // smallest node worth building its subtrees on separate threads
+  static const uint kParallelBuildSize = 1 << 16;
 
   // smallest value represented by this node
   uint low;
   // highest value represented by this node
   uint high;
   // bitvector of the values
-  BitVector bitvec;
+  BitVectorType bitvec;
   // left node
   WaveletTreeNodePointer left;
   // right node
@@ -29,42 +36,79 @@ class WaveletTreeNode {
 
   uint get_mid() const { return low + (high - low) / 2; }
 
-  WaveletTreeNode() : low(0), high(0), bitvec(), left(NULL), right(NULL) {}
+  BasicWaveletTreeNode()
+      : low(0), high(0), bitvec(), left(NULL), right(NULL) {}
 
-  WaveletTreeNode(std::vector<uint> values, uint start, uint end, uint low,
-                  uint high)
-      : WaveletTreeNode() {
-    build(values, start, end, low, high);
+  BasicWaveletTreeNode(std::vector<uint> values, uint start, uint end,
+                       uint low, uint high)
+      : BasicWaveletTreeNode() {
+    std::vector<uint> scratch(values.size());
+    build(values, scratch, start, end, low, high);
   }
 
-  WaveletTreeNode(const std::initializer_list<uint>& values, uint start,
-                  uint end, uint low, uint high)
-      : WaveletTreeNode(std::vector<uint>(values), start, end, low, high) {}
+  BasicWaveletTreeNode(const std::initializer_list<uint>& values, uint start,
+                       uint end, uint low, uint high)
+      : BasicWaveletTreeNode(std::vector<uint>(values), start, end, low,
+                             high) {}
+
+  /*
+    Build the node for values[start, end), partitioning that range in place.
+    scratch is shared by the whole tree, with the same size as values, and
+    the node only uses its [start, end) range, so sibling subtrees can be
+    built concurrently on up to the given number of threads.
+  */
+  BasicWaveletTreeNode(std::vector<uint>& values, std::vector<uint>& scratch,
+                       uint start, uint end, uint low, uint high,
+                       uint threads = 1)
+      : BasicWaveletTreeNode() {
+    build(values, scratch, start, end, low, high, threads);
+  }
 
-  ~WaveletTreeNode() {
+  ~BasicWaveletTreeNode() {
     if (left) delete left;
     if (right) delete right;
   }
 
-  void build(std::vector<uint>& values, uint start, uint end, uint low,
-             uint high) {
+  void build(std::vector<uint>& values, std::vector<uint>& scratch,
+             uint start, uint end, uint low, uint high, uint threads = 1) {
     this->low = low;
     this->high = high;
     if (start == end || low == high) return;
 
     uint mid = get_mid();
-    auto checker = [&mid](uint val) -> bool { return val <= mid; };
-
     uint sz = end - start;
     BitArray b(sz);
-    for (uint i = 0; i < sz; i++) b.write(i, !checker(values[start + i]));
-    auto pivot_idx = std::stable_partition(values.begin() + start,
-                                           values.begin() + end, checker) -
-                     values.begin();
+    // stable partition: values <= mid stay on values, the others go to
+    // scratch and are copied back right after them
+    uint pivot_idx = start, n_right = 0;
+    for (uint i = start; i < end; i++) {
+      if (values[i] <= mid) {
+        values[pivot_idx++] = values[i];
+      } else {
+        b.write(i - start, 1);
+        scratch[start + n_right++] = values[i];
+      }
+    }
+    std::copy(scratch.begin() + start, scratch.begin() + start + n_right,
+              values.begin() + pivot_idx);
+
+    if (threads > 1 && sz >= kParallelBuildSize) {
+      // the right subtree gets its own thread, this one builds the rest
+      std::thread right_builder([&]() {
+        right = new BasicWaveletTreeNode(values, scratch, pivot_idx, end,
+                                         mid + 1, high, threads / 2);
+      });
+      bitvec.reset(b);
+      left = new BasicWaveletTreeNode(values, scratch, start, pivot_idx, low,
+                                      mid, threads - threads / 2);
+      right_builder.join();
+      return;
+    }
     bitvec.reset(b);
-
-    left = new WaveletTreeNode(values, start, pivot_idx, low, mid);
-    right = new WaveletTreeNode(values, pivot_idx, end, mid + 1, high);
+    left = new BasicWaveletTreeNode(values, scratch, start, pivot_idx, low,
+                                    mid);
+    right = new BasicWaveletTreeNode(values, scratch, pivot_idx, end, mid + 1,
+                                     high);
   }
 
   uint size() const { return bitvec.size(); }
@@ -129,6 +173,50 @@ class WaveletTreeNode {
     }
   }
 
+  // values v <= max_value of [l, r) with odd frequency on [l, m) or
+  // appearing on [m, r), in increasing order
+  void range_active_values(uint l, uint m, uint r, uint max_value,
+                           std::vector<uint>& values) const {
+    if (l >= r || low > max_value) return;
+    if (low == high) {
+      if (((m - l) & 1) || m < r) values.push_back(low);
+      return;
+    }
+    uint ones_l = bitvec.rank(l), ones_m = bitvec.rank(m),
+         ones_r = bitvec.rank(r);
+    if (left) {
+      left->range_active_values(l - ones_l, m - ones_m, r - ones_r, max_value,
+                                values);
+    }
+    if (right) {
+      right->range_active_values(ones_l, ones_m, ones_r, max_value, values);
+    }
+  }
+
+  /*
+    Write the values on positions [l, r) of this node to out[0, r - l). The
+    children decode their ranges into scratch, using out as their own scratch
+    space, and this node merges them following its bitvector.
+  */
+  void decode_range(uint l, uint r, uint* out, uint* scratch) const {
+    if (l >= r) return;
+    if (low == high) {
+      std::fill(out, out + (r - l), low);
+      return;
+    }
+    uint ones_l = bitvec.rank(l), ones_r = bitvec.rank(r);
+    uint n_zeros = (r - l) - (ones_r - ones_l);
+    if (left) left->decode_range(l - ones_l, r - ones_r, scratch, out);
+    if (right) {
+      right->decode_range(ones_l, ones_r, scratch + n_zeros, out + n_zeros);
+    }
+    const uint* zeros = scratch;
+    const uint* ones = scratch + n_zeros;
+    for (uint i = l; i < r; i++) {
+      out[i - l] = bitvec[i] ? *ones++ : *zeros++;
+    }
+  }
+
   // measure memory used in bytes
   uint measure_memory() const {
     uint l = (left) ? left->measure_memory() : 0;
@@ -140,32 +228,48 @@ class WaveletTreeNode {
 
 // ========================= Wavelet Tree ========================
 
-class WaveletTree : public WaveletTreeInterface {
+/*
+  Use WaveletTree for nodes with 32-bit cell bitvectors and WaveletTree64 for
+  64-bit cell ones. AdaptiveWaveletTree compresses the bitvectors of the
+  sparse nodes (see BasicAdaptiveBitVector).
+*/
+template <typename BitVectorType = BitVector>
+class BasicWaveletTree : public WaveletTreeInterface {
  public:
-  using Node = WaveletTreeNode;
-  using NodePtr = WaveletTreeNode::WaveletTreeNodePointer;
+  using Node = BasicWaveletTreeNode<BitVectorType>;
+  using NodePtr = typename Node::WaveletTreeNodePointer;
 
-  WaveletTree() : root(NULL) {}
+  BasicWaveletTree() : root(NULL) {}
 
-  WaveletTree(const std::vector<uint>& values) : WaveletTree() {
+  BasicWaveletTree(const std::vector<uint>& values) : BasicWaveletTree() {
     reset(values);
   }
 
-  WaveletTree(const std::initializer_list<uint>& values)
-      : WaveletTree(std::vector<uint>(values)) {}
+  BasicWaveletTree(const std::initializer_list<uint>& values)
+      : BasicWaveletTree(std::vector<uint>(values)) {}
 
-  ~WaveletTree() {
+  ~BasicWaveletTree() {
     if (root) delete root;
   }
 
   void reset(const std::vector<uint>& values) {
+    reset(std::vector<uint>(values));
+  }
+
+  /*
+    Build the tree using values as the working buffer, so the only extra
+    memory is a single scratch array of the same size. Subtrees are built
+    concurrently on up to the given number of threads.
+  */
+  void reset(std::vector<uint>&& values, uint threads = 1) {
     if (root) {
       delete root;
       root = NULL;
     }
     low = *std::min_element(values.begin(), values.end());
     high = *std::max_element(values.begin(), values.end());
-    root = new WaveletTreeNode(values, 0, values.size(), low, high);
+    std::vector<uint> scratch(values.size());
+    root = new Node(values, scratch, 0, values.size(), low, high, threads);
   }
 
   uint size() const { return root->size(); }
@@ -252,13 +356,87 @@ class WaveletTree : public WaveletTreeInterface {
     root->range_report(l, r + 1, report_container);
   }
 
+  /*
+    Append to values, in increasing order, the distinct values v <= max_value
+    on [l, r) that either appear an odd number of times on [l, m) or appear
+    at least once on [m, r), with l <= m <= r. Everything is solved in a
+    single traversal that skips the nodes above max_value.
+  */
+  void range_active_values(uint l, uint m, uint r, uint max_value,
+                           std::vector<uint>& values) const {
+    if (!root || l >= r || r > size() || m < l || m > r) return;
+    root->range_active_values(l, m, r, max_value, values);
+  }
+
+  /*
+    Decode the values on positions [l, r) with a single traversal of the
+    nodes covering the range, instead of a root to leaf walk per value
+  */
+  void decode_range(uint l, uint r, std::vector<uint>& values) const {
+    values.clear();
+    if (!root) return;
+    r = std::min(r, size());
+    if (l >= r) return;
+    values.resize(r - l);
+    std::vector<uint> scratch(r - l);
+    root->decode_range(l, r, values.data(), scratch.data());
+  }
+
+  /*
+    Forward cursor, decoding kCursorBlockSize values at a time with
+    decode_range
+  */
+  class Cursor : public ArrayCursor<Cursor> {
+   public:
+    using ArrayCursor<Cursor>::operator++;
+
+    static const uint kCursorBlockSize = 64;
+
+    Cursor() : tree(NULL), idx(0), block_start(0) {}
+
+    Cursor(const BasicWaveletTree* tree, uint idx)
+        : tree(tree), idx(idx), block_start(idx) {
+      load_block();
+    }
+
+    uint operator*() const { return block[idx - block_start]; }
+
+    Cursor& operator++() {
+      if (++idx == block_start + block.size()) {
+        block_start = idx;
+        load_block();
+      }
+      return *this;
+    }
+
+    uint index() const { return idx; }
+
+   private:
+    const BasicWaveletTree* tree;
+    uint idx;
+    // values on [block_start, block_start + block.size())
+    uint block_start;
+    std::vector<uint> block;
+
+    void load_block() {
+      tree->decode_range(block_start, block_start + kCursorBlockSize, block);
+    }
+  };
+
+  Cursor begin() const { return Cursor(this, 0); }
+
+  Cursor end() const { return Cursor(this, size()); }
+
+  // cursor pointing to position idx
+  Cursor cursor(uint idx) const { return Cursor(this, std::min(idx, size())); }
+
   uint operator[](uint idx) const override { return access(idx); }
 
   std::string to_string() const {
     std::string s("WaveletTree: [");
-    for (uint i = 0; i < size(); i++) {
-      if (i) s += ",";
-      s += std::to_string(access(i));
+    for (Cursor it = begin(), last = end(); it != last; ++it) {
+      if (it.index()) s += ",";
+      s += std::to_string(*it);
     }
     s += "]";
     return s;
@@ -289,5 +467,10 @@ class WaveletTree : public WaveletTreeInterface {
   }
 };
 
+using WaveletTreeNode = BasicWaveletTreeNode<BitVector>;
+using WaveletTree = BasicWaveletTree<BitVector>;
+using WaveletTree64 = BasicWaveletTree<BitVector64>;
+using AdaptiveWaveletTree = BasicWaveletTree<AdaptiveBitVector>;
+
 }  // namespace lib
 }  // namespace compact
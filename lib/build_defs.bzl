@@ -0,0 +1,18 @@
+"""Build macros of the compact library."""
+
+def cc_policy_test(name, local_defines = [], **kwargs):
+    """cc_test run under both access policies (see lib/utils/AccessPolicy.h).
+
+    Defines <name>, with the argument checks on, and <name>_unchecked, built
+    with COMPACT_UNCHECKED so the checks are compiled out.
+    """
+    native.cc_test(
+        name = name,
+        local_defines = local_defines,
+        **kwargs
+    )
+    native.cc_test(
+        name = name + "_unchecked",
+        local_defines = local_defines + ["COMPACT_UNCHECKED"],
+        **kwargs
+    )
@@ -1,10 +1,16 @@
+#include <algorithm>
 #include <exception>
+#include <numeric>
 #include <vector>
 
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "lib/BitArray.h"
+#include "lib/BitStream.h"
+#include "lib/EliasFano.h"
 #include "lib/FixedSizeArray.h"
+#include "lib/FixedWidthArray.h"
+#include "lib/HuffmanArray.h"
 #include "lib/VariableSizeArray.h"
 #include "lib/VariableSizeDenseArray.h"
 
@@ -50,19 +56,21 @@ TEST(ArrayTest, fixedSizeArrayTest) {
   v[1] = 12;
   EXPECT_EQ(arr[1], v[1]);
 
-  // access index out of bounds: should fail
-  try {
-    arr.write(7, 0);
-    LOG(FATAL) << "Uncaught exception!";
-  } catch (std::exception& e) {
-    LOG(INFO) << "Caught exception: " << e.what();
-  }
+  // access index out of bounds: should fail, if checked
+  if (kCheckedAccess) {
+    try {
+      arr.write(7, 0);
+      LOG(FATAL) << "Uncaught exception!";
+    } catch (std::exception& e) {
+      LOG(INFO) << "Caught exception: " << e.what();
+    }
 
-  try {
-    arr.read(-1);
-    LOG(FATAL) << "Uncaught exception!";
-  } catch (std::exception& e) {
-    LOG(INFO) << "Caught exception: " << e.what();
+    try {
+      arr.read(-1);
+      LOG(FATAL) << "Uncaught exception!";
+    } catch (std::exception& e) {
+      LOG(INFO) << "Caught exception: " << e.what();
+    }
   }
 
   /*
@@ -104,6 +112,61 @@ TEST(ArrayTest, fixedSizeArrayTest) {
   EXPECT_EQ(arr2, arr3);
 }
 
+// test arrays of compile-time and runtime widths against FixedSizeArray
+TEST(ArrayTest, fixedWidthArrayTest) {
+  const uint n = 200;
+  for (uint width = 1; width <= kMaxFixedWidth; width++) {
+    uint mask = BitmaskUtility::get_full_ones(width);
+    std::vector<uint> values(n);
+    for (uint i = 0; i < n; i++) values[i] = (i * 2654435761u) & mask;
+
+    FixedSizeArray expected(values, width);
+    DynamicWidthArray dynamic_arr;
+    dynamic_arr.reset(values, width);
+    EXPECT_EQ(dynamic_arr.size(), n);
+    EXPECT_EQ(dynamic_arr.get_bit_size(), width);
+
+    dispatch_fixed_width(width, [&](auto w) {
+      FixedWidthArray<decltype(w)::value> arr(values);
+      EXPECT_EQ(arr.size(), n);
+      for (uint i = 0; i < n; i++) {
+        EXPECT_EQ(arr.get(i), expected[i]);
+        EXPECT_EQ(arr[i], expected[i]);
+        EXPECT_EQ(dynamic_arr.get(i), expected[i]);
+      }
+
+      // overwrite every other element, keeping its neighbours intact
+      for (uint i = 0; i < n; i += 2) {
+        arr.set(i, ~values[i]);
+        dynamic_arr.write(i, ~values[i]);
+        expected.write(i, ~values[i] & mask);
+      }
+      for (uint i = 0; i < n; i++) {
+        EXPECT_EQ(arr.get(i), expected[i]);
+        EXPECT_EQ(dynamic_arr[i], expected[i]);
+      }
+    });
+  }
+
+  FixedWidthArray<5> arr{22, 9, 12};
+  EXPECT_EQ(arr.to_string(), "[22,9,12]");
+  if (kCheckedAccess) {
+    EXPECT_THROW(arr.read(3), std::runtime_error);
+    EXPECT_THROW(arr.write(3, 0), std::runtime_error);
+  }
+
+  // invalid widths are rejected under both access policies
+  DynamicWidthArray dynamic_arr;
+  EXPECT_THROW(dynamic_arr.resize(10, 0), std::runtime_error);
+  EXPECT_THROW(dynamic_arr.resize(10, kMaxFixedWidth + 1),
+               std::runtime_error);
+  dynamic_arr.assign(3, 7, 3);
+  EXPECT_EQ(dynamic_arr.to_string(), "[7,7,7]");
+  if (kCheckedAccess) {
+    EXPECT_THROW(dynamic_arr.read(3), std::runtime_error);
+  }
+}
+
 // test array of variable-length elements
 TEST(ArrayTest, variableSizeArrayTest) {
   /*
@@ -134,6 +197,58 @@ TEST(ArrayTest, variableSizeArrayTest) {
               << ", arr = " << arr2[i];
     EXPECT_EQ(arr2[i], values2[i]);
   }
+
+  // batch decoding across several blocks, with values below the minimum one
+  std::vector<uint> values3;
+  for (uint i = 0; i < 100; i++) values3.push_back(7 + (i * 37) % 1000);
+  VariableSizeDenseArray arr3(values3);
+  std::vector<uint> decoded;
+  arr3.decode_range(0, 1000, decoded);
+  EXPECT_EQ(decoded, values3);
+  arr3.decode_range(21, 67, decoded);
+  EXPECT_EQ(decoded,
+            std::vector<uint>(values3.begin() + 21, values3.begin() + 67));
+  arr3.decode_range(99, 99, decoded);
+  EXPECT_TRUE(decoded.empty());
+
+  // block decoding of codes up to 31 bits long, starting around block edges
+  std::vector<uint> values4;
+  for (uint i = 0; i < 70; i++) values4.push_back(i % 3 ? 0x80000000u + i : i);
+  VariableSizeDenseArray arr4(values4);
+  for (uint l : {0, 21, 22, 23, 43, 44, 66}) {
+    arr4.decode_range(l, l + 24, decoded);
+    uint r = std::min(l + 24, 70u);
+    EXPECT_EQ(decoded,
+              std::vector<uint>(values4.begin() + l, values4.begin() + r));
+    auto it = arr4.cursor(l);
+    for (uint j = l; j < values4.size(); j++) EXPECT_EQ(*it++, values4[j]);
+    EXPECT_TRUE(it == arr4.end());
+  }
+}
+
+// test sampling rates and range decoding of variable-length arrays
+TEST(ArrayTest, variableSizeArraySamplingTest) {
+  std::vector<uint> values;
+  for (uint i = 0; i < 200; i++) values.push_back((i * 7919) % (1 << (i % 20)));
+
+  for (uint rate : {1, 2, 7, 22, 500}) {
+    VariableSizeArray gama(values, rate);
+    DeltaVariableSizeArray delta(values, rate);
+    EXPECT_EQ(gama.get_sample_rate(), rate);
+    for (uint i = 0; i < values.size(); i++) {
+      EXPECT_EQ(gama[i], values[i]);
+      EXPECT_EQ(delta[i], values[i]);
+    }
+
+    std::vector<uint> decoded;
+    gama.decode_range(13, 150, decoded);
+    EXPECT_EQ(decoded,
+              std::vector<uint>(values.begin() + 13, values.begin() + 150));
+    delta.decode_range(0, values.size() + 10, decoded);
+    EXPECT_EQ(decoded, values);
+    delta.decode_range(50, 50, decoded);
+    EXPECT_TRUE(decoded.empty());
+  }
 }
 
 // test array of BitArray
@@ -170,6 +285,214 @@ TEST(ArrayTest, bitArrayTest) {
   EXPECT_EQ(arr.measure_memory(), 20);
 }
 
+// test arrays stored on 64-bit cells
+TEST(ArrayTest, wordSize64Test) {
+  /*
+    init
+
+    Array of seven 11-bit-length elements. Element 5 straddles the first and
+    the second 64-bit cells
+  */
+  FixedSizeArray64 arr(7, 11);
+  std::vector<uint> v{2047, 1, 1024, 777, 5, 1500, 3};
+  for (uint i = 0; i < v.size(); i++) arr.write(i, v[i]);
+  for (uint i = 0; i < v.size(); i++) EXPECT_EQ(arr[i], v[i]);
+
+  // copies are deep
+  FixedSizeArray64 copy(arr);
+  copy.write(5, 0);
+  EXPECT_EQ(arr[5], v[5]);
+  EXPECT_EQ(copy[5], 0);
+
+  /*
+    bit_stream:
+    bits 62..65 active, straddling the 64-bit cells
+  */
+  std::vector<uint> bit_stream(100);
+  bit_stream[62] = bit_stream[63] = bit_stream[64] = bit_stream[65] = 1;
+  BitArray64 bits(bit_stream);
+  for (uint i = 0; i < bits.size(); i++) {
+    EXPECT_EQ(bits[i], bit_stream[i]);
+  }
+  EXPECT_EQ(bits.read_interval(0, 63), 0xC000000000000000ULL);
+  EXPECT_EQ(bits.read_interval(62, 65), 15);
+  EXPECT_EQ(bits.read_interval(40, 99), 15ULL << 22);
+  EXPECT_EQ(bits.measure_memory(), 12 + 2 * 8);
+}
+
+template <typename BitArrayType>
+void run_bit_stream_tests() {
+  /*
+    init
+
+    codes of every length up to 32 bits, written after a 5-bit prefix that
+    must be kept, and followed by 7 bits that must be kept too
+  */
+  std::vector<std::pair<uint, uint>> codes;
+  uint total = 0;
+  for (uint i = 0; i < 100; i++) {
+    uint len = i % 33;
+    uint code = (2654435761u * (i + 1)) & BitmaskUtility::get_full_ones(len);
+    codes.push_back({code, len});
+    total += len;
+  }
+  BitArrayType bits(5 + total + 7);
+  for (uint i = 0; i < 5; i++) bits.write(i, 1);
+  for (uint i = 5 + total; i < bits.size(); i++) bits.write(i, 1);
+
+  BasicBitWriter<BitArrayType> writer(bits, 5);
+  for (auto& code : codes) writer.write(code.first, code.second);
+  writer.flush();
+  EXPECT_EQ(writer.position(), 5 + total);
+  EXPECT_THROW(writer.write(0, 8), std::runtime_error);
+
+  // bit by bit check
+  uint pos = 5;
+  for (uint i = 0; i < 5; i++) EXPECT_EQ(bits[i], 1);
+  for (auto& code : codes) {
+    for (uint i = 0; i < code.second; i++, pos++) {
+      EXPECT_EQ(bits[pos], 1 & (code.first >> i));
+    }
+  }
+  for (; pos < bits.size(); pos++) EXPECT_EQ(bits[pos], 1);
+
+  BasicBitReader<BitArrayType> reader(bits, 5);
+  for (auto& code : codes) EXPECT_EQ(reader.read(code.second), code.first);
+  EXPECT_EQ(reader.position(), 5 + total);
+  EXPECT_EQ(reader.read(7), 127);
+  EXPECT_TRUE(reader.empty());
+
+  // most significant bit first codes and zero counting
+  BitArrayType gama(40);
+  BasicBitWriter<BitArrayType> gama_writer(gama, 3);
+  gama_writer.write_zeros(35);
+  gama_writer.write_reversed(2, 2);
+  gama_writer.flush();
+  BasicBitReader<BitArrayType> gama_reader(gama, 3);
+  EXPECT_EQ(gama_reader.count_zeros(), 35);
+  gama_reader.skip(35);
+  EXPECT_EQ(gama_reader.read_reversed(2), 2);
+}
+
+// test the word-at-a-time bit writer and reader
+TEST(ArrayTest, bitStreamTest) {
+  run_bit_stream_tests<BitArray>();
+  run_bit_stream_tests<BitArray64>();
+}
+
+// test huffman array random access
+TEST(ArrayTest, huffmanArrayTest) {
+  // init: sorted values spanning several sampled blocks
+  std::vector<uint> values;
+  for (uint i = 0; i < 100; i++) values.push_back(3 * (i / 2) + i % 3);
+  std::sort(values.begin(), values.end());
+  HuffmanArray arr(values, 8);
+  EXPECT_EQ(arr.size(), values.size());
+  for (uint i = 0; i < values.size(); i++) EXPECT_EQ(arr[i], values[i]);
+
+  std::vector<uint> decoded;
+  arr.decode_range(13, 42, decoded);
+  EXPECT_EQ(decoded,
+            std::vector<uint>(values.begin() + 13, values.begin() + 42));
+  arr.decode(decoded);
+  EXPECT_EQ(decoded, values);
+
+  for (uint v = 0; v <= values.back() + 1; v++) {
+    EXPECT_EQ(arr.lower_bound(v),
+              std::lower_bound(values.begin(), values.end(), v) -
+                  values.begin());
+  }
+
+  // values going up and down
+  std::vector<uint> unsorted{5, 1, 9, 9, 0, 7, 3, 3, 12, 4};
+  arr = HuffmanArray(unsorted, 3);
+  for (uint i = 0; i < unsorted.size(); i++) EXPECT_EQ(arr[i], unsorted[i]);
+
+  arr.reset(std::vector<uint>());
+  EXPECT_EQ(arr.size(), 0);
+  EXPECT_EQ(arr.lower_bound(1), 0);
+}
+
+// test Elias-Fano monotone sequence
+TEST(ArrayTest, eliasFanoTest) {
+  // init: repeated values, gaps and a large universe
+  std::vector<uint> values{0, 0, 3, 7, 7, 8, 100, 1000, 1001, 50000};
+  EliasFanoArray arr(values);
+  EXPECT_EQ(arr.size(), values.size());
+  for (uint i = 0; i < values.size(); i++) EXPECT_EQ(arr[i], values[i]);
+
+  for (uint v = 0; v <= values.back() + 1; v++) {
+    EXPECT_EQ(arr.next_geq(v), std::lower_bound(values.begin(), values.end(),
+                                                v) -
+                                   values.begin());
+    EXPECT_EQ(arr.next_gt(v), std::upper_bound(values.begin(), values.end(),
+                                               v) -
+                                  values.begin());
+  }
+
+  std::vector<uint> decoded;
+  arr.decode_range(2, 8, decoded);
+  EXPECT_EQ(decoded, std::vector<uint>(values.begin() + 2, values.begin() + 8));
+
+  // copies keep working after the original is gone
+  EliasFanoArray copy;
+  {
+    EliasFanoArray tmp({5, 6, 9});
+    copy = tmp;
+  }
+  EXPECT_EQ(copy[2], 9);
+  EXPECT_EQ(copy.next_geq(7), 2);
+
+  arr.reset(std::vector<uint>());
+  EXPECT_EQ(arr.size(), 0);
+  EXPECT_EQ(arr.next_geq(3), 0);
+}
+
+template <typename ArrayType>
+void run_cursor_tests(const ArrayType& arr, const std::vector<uint>& values) {
+  // range-for
+  std::vector<uint> scanned;
+  for (uint val : arr) scanned.push_back(val);
+  EXPECT_EQ(scanned, values);
+
+  // STL algorithms
+  EXPECT_EQ(std::vector<uint>(arr.begin(), arr.end()), values);
+  EXPECT_EQ(std::accumulate(arr.begin(), arr.end(), 0ULL),
+            std::accumulate(values.begin(), values.end(), 0ULL));
+  EXPECT_EQ(std::count(arr.begin(), arr.end(), values[3]),
+            std::count(values.begin(), values.end(), values[3]));
+
+  // cursors starting in the middle
+  for (uint i = 0; i <= values.size(); i += 7) {
+    auto it = arr.cursor(i);
+    EXPECT_EQ(it.index(), i);
+    for (uint j = i; j < std::min<uint>(values.size(), i + 10); j++) {
+      EXPECT_EQ(*it++, values[j]);
+    }
+  }
+  EXPECT_TRUE(arr.cursor(values.size() + 5) == arr.end());
+}
+
+// test sequential cursors of every array
+TEST(ArrayTest, cursorTest) {
+  std::vector<uint> values, bits;
+  for (uint i = 0; i < 150; i++) {
+    values.push_back((i * 2654435761u) % (1 << 11));
+    bits.push_back(values.back() & 1);
+  }
+  std::vector<uint> sorted(values);
+  std::sort(sorted.begin(), sorted.end());
+
+  run_cursor_tests(FixedSizeArray(values, 11), values);
+  run_cursor_tests(FixedSizeArray64(values, 11), values);
+  run_cursor_tests(BitArray(bits), bits);
+  run_cursor_tests(BitArray64(bits), bits);
+  run_cursor_tests(VariableSizeArray(values, 5), values);
+  run_cursor_tests(DeltaVariableSizeArray(values), values);
+  run_cursor_tests(VariableSizeDenseArray(values), values);
+  run_cursor_tests(HuffmanArray(sorted, 8), sorted);
+}
+
 }  // namespace test
 }  // namespace lib
-}  // namespace compact
\ No newline at end of file
+}  // namespace compact
@@ -2,6 +2,7 @@
 #include <time.h>
 
 #include <exception>
+#include <thread>
 #include <vector>
 
 #include "glog/logging.h"
@@ -9,7 +10,10 @@
 #include "lib/BitArray.h"
 #include "lib/BitVector.h"
 #include "lib/ClarkSelect.h"
+#include "lib/InterleavedRank.h"
 #include "lib/JacobsonRank.h"
+#include "lib/RRRBitVector.h"
+#include "lib/SampledSelect.h"
 #include "lib/VariableSizeArray.h"
 
 namespace compact {
@@ -115,6 +119,65 @@ TEST(BitVectorTest, bitVectorTest) {
   }
 }
 
+// test eager, lazy and rank-only select, and concurrent lazy builds
+TEST(BitVectorTest, selectSupportTest) {
+  auto bit_stream = get_random_bitarray(3000, 30);
+  BitVector eager(bit_stream, kEagerSelect);
+  BitVector64 lazy(bit_stream);
+  BitVector no_select(bit_stream, kNoSelect);
+  EXPECT_EQ(lazy.get_select_support(), kLazySelect);
+  EXPECT_LT(no_select.measure_memory(), eager.measure_memory());
+
+  uint lazy_memory = lazy.measure_memory();
+  for (uint bit_value = 0; bit_value < 2; bit_value++) {
+    for (uint i = 0; i <= bit_stream.size(); i++) {
+      uint expected = linear_select(bit_stream, i, bit_value);
+      EXPECT_EQ(eager.select(i, bit_value), expected);
+      EXPECT_EQ(lazy.select(i, bit_value), expected);
+      EXPECT_EQ(no_select.select(i, bit_value), expected);
+    }
+  }
+  EXPECT_GT(lazy.measure_memory(), lazy_memory);
+
+  // copies keep the select support, and build on their own first select
+  BitVector copy(no_select);
+  EXPECT_EQ(copy.get_select_support(), kNoSelect);
+  BitVector64 lazy_copy(lazy);
+  EXPECT_EQ(lazy_copy.measure_memory(), lazy_memory);
+
+  const uint n_threads = 4;
+  std::vector<uint> mismatches(n_threads, 0);
+  std::vector<std::thread> threads;
+  for (uint t = 0; t < n_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (uint i = t; i < bit_stream.size(); i += n_threads) {
+        uint bit_value = i % 2;
+        mismatches[t] += lazy_copy.select(i / 2, bit_value) !=
+                         eager.select(i / 2, bit_value);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(std::vector<uint>(n_threads, 0), mismatches);
+}
+
+// test BitVector stored on 64-bit cells
+TEST(BitVectorTest, bitVector64Test) {
+  for (uint p = 0; p <= 100; p += 25) {
+    auto bit_stream = get_random_bitarray(1000, p);
+    BitVector64 bitv(bit_stream);
+    for (uint bit_value = 0; bit_value < 2; bit_value++) {
+      for (uint i = 0; i < bitv.size(); i++) {
+        EXPECT_EQ(bitv.rank(i, bit_value),
+                  linear_rank(bit_stream, i, bit_value));
+        EXPECT_EQ(bitv.select(i, bit_value),
+                  linear_select(bit_stream, i, bit_value));
+        EXPECT_EQ(bitv[i], bit_stream[i]);
+      }
+    }
+  }
+}
+
 // test rank
 TEST(BitVectorTest, jacobsonRankTest) {
   /*
@@ -133,6 +196,33 @@ TEST(BitVectorTest, jacobsonRankTest) {
   }
 }
 
+// test rank counters interleaved with the bits
+TEST(BitVectorTest, interleavedRankTest) {
+  uint iterations = 20;
+  for (uint i = 0; i < iterations; i++) {
+    uint p = i * (100 / iterations);
+    BitArray bitv = get_random_bitarray(3000, p);
+    InterleavedBitArray bits;
+    bits.reset(bitv);
+    InterleavedRank rank_manager(bits);
+    rank_manager.build();
+    for (uint j = 0; j <= bitv.size(); j++) {
+      EXPECT_EQ(rank_manager.rank(j), linear_rank(bitv, j));
+    }
+    for (uint j = 0; j + 40 <= bitv.size(); j += 7) {
+      uint64_t low = bitv.read_interval(j, j + 31);
+      uint64_t high = bitv.read_interval(j + 32, j + 39);
+      EXPECT_EQ(bits.read_interval(j, j + 39), low | (high << 32));
+    }
+  }
+
+  InterleavedBitArray ones;
+  ones.assign(1000, 1);
+  ones.build();
+  EXPECT_EQ(ones.rank(1000), 1000);
+  EXPECT_EQ(ones.rank(777), 777);
+}
+
 // test BitVector
 TEST(BitVectorTest, clarkSelectTest) {
   /*
@@ -164,6 +254,90 @@ TEST(BitVectorTest, clarkSelectTest) {
   }
 }
 
+// test select sampled over the interleaved rank directory
+TEST(BitVectorTest, sampledSelectTest) {
+  for (uint bit_value = 0; bit_value < 2; bit_value++) {
+    for (uint p = 0; p <= 100; p += 5) {
+      BitArray bitv = get_random_bitarray(5000, p);
+      InterleavedBitArray bits;
+      bits.reset(bitv);
+      bits.build();
+      SampledSelect select_manager(bits, bit_value);
+      select_manager.build();
+      for (uint j = 0; j <= bitv.size(); j++) {
+        EXPECT_EQ(select_manager.select(j), linear_select(bitv, j, bit_value));
+      }
+    }
+  }
+}
+
+// test the RRR compressed bitvector, including a clustered bit stream
+TEST(BitVectorTest, rrrBitVectorTest) {
+  std::vector<BitArray> streams;
+  for (uint p = 0; p <= 100; p += 10) {
+    streams.push_back(get_random_bitarray(3001, p));
+  }
+  BitArray runs(5000);
+  for (uint i = 0; i < runs.size(); i++) runs.write(i, (i / 700) % 2);
+  streams.push_back(runs);
+
+  for (const BitArray& bit_stream : streams) {
+    RRRBitVector bitv;
+    bitv.reset(bit_stream);
+    EXPECT_EQ(bitv.size(), bit_stream.size());
+    for (uint bit_value = 0; bit_value < 2; bit_value++) {
+      for (uint i = 0; i <= bitv.size(); i++) {
+        EXPECT_EQ(bitv.rank(i, bit_value),
+                  linear_rank(bit_stream, i, bit_value));
+        EXPECT_EQ(bitv.select(i, bit_value),
+                  linear_select(bit_stream, i, bit_value));
+      }
+    }
+    for (uint i = 0; i < bitv.size(); i++) EXPECT_EQ(bitv[i], bit_stream[i]);
+  }
+
+  // long runs take a fraction of the plain bits
+  EXPECT_LT(RRRBitVector(std::vector<uint>(10000, 1)).measure_memory(),
+            BitArray(10000).measure_memory() / 2);
+
+  RRRBitVector empty;
+  EXPECT_EQ(empty.rank(0), 0);
+  EXPECT_EQ(empty.select(0), 0);
+  RRRBitVector small{1, 0, 1};
+  EXPECT_EQ(small.to_string(), "[1,0,1]");
+  EXPECT_EQ(small.select(1, 1), 2);
+}
+
+// test the bitvector choosing the RRR representation by density
+TEST(BitVectorTest, adaptiveBitVectorTest) {
+  for (uint p = 0; p <= 100; p += 5) {
+    auto bit_stream = get_random_bitarray(2000, p);
+    AdaptiveBitVector64 bitv;
+    bitv.reset(bit_stream);
+    uint ones = linear_rank(bit_stream, bit_stream.size());
+    uint minority = std::min(ones, bit_stream.size() - ones);
+    EXPECT_EQ(bitv.is_compressed(), minority <= 0.125 * bit_stream.size());
+    for (uint bit_value = 0; bit_value < 2; bit_value++) {
+      for (uint i = 0; i < bitv.size(); i += 3) {
+        EXPECT_EQ(bitv.rank(i, bit_value),
+                  linear_rank(bit_stream, i, bit_value));
+        EXPECT_EQ(bitv.select(i, bit_value),
+                  linear_select(bit_stream, i, bit_value));
+        EXPECT_EQ(bitv[i], bit_stream[i]);
+      }
+    }
+  }
+
+  AdaptiveBitVector copy;
+  {
+    AdaptiveBitVector bitv{0, 1, 1, 0, 1, 1, 1, 0, 1};
+    EXPECT_FALSE(bitv.is_compressed());
+    copy = bitv;
+  }
+  EXPECT_EQ(copy.to_string(), "[0,1,1,0,1,1,1,0,1]");
+  EXPECT_EQ(copy.select(2, 0), 7);
+}
+
 }  // namespace test
 }  // namespace lib
 }  // namespace compact
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "lib/utils/BitmaskUtility.h"
 #include "lib/utils/DeltaGapUtility.h"
 #include "lib/utils/DensePointersUtility.h"
+#include "lib/utils/EliasDeltaUtility.h"
 #include "lib/utils/GamaUtility.h"
 #include "lib/utils/HuffmanUtility.h"
 #include "lib/utils/Utils.h"
@@ -64,6 +65,35 @@ TEST(GamaUtilityTest, gamaCompressionTest) {
   }
 }
 
+// test delta-compression utilities and word-parallel decoding
+TEST(EliasDeltaUtilityTest, eliasDeltaCompressionTest) {
+  BitArray code = EliasDeltaUtility::get_code(6);
+  BitArray arr1{0, 1, 1, 1, 1};
+  EXPECT_EQ(arr1, code);
+
+  // values of every length, including the largest ones
+  std::vector<uint> values{0, 1, 2, 6, 31, 1000, 65535, UINT32_MAX - 1};
+  for (uint i = 0; i < 32; i++) values.push_back((1u << i) - 1);
+  BitArray gama_stream = GamaUtility::get_array_code(values);
+  BitArray delta_stream = EliasDeltaUtility::get_array_code(values);
+
+  uint gama_start = 0, delta_start = 0;
+  BitReader gama_reader(gama_stream), delta_reader(delta_stream);
+  for (uint i = 0; i < values.size(); i++) {
+    EXPECT_EQ(GamaUtility::decode_next(gama_stream, gama_start), values[i]);
+    EXPECT_EQ(GamaUtility::decode_next(gama_reader), values[i]);
+    EXPECT_EQ(EliasDeltaUtility::decode_next(delta_stream, delta_start),
+              values[i]);
+    EXPECT_EQ(EliasDeltaUtility::decode_next(delta_reader), values[i]);
+  }
+  EXPECT_EQ(gama_start, gama_stream.size());
+  EXPECT_EQ(delta_start, delta_stream.size());
+  EXPECT_TRUE(gama_reader.empty());
+  EXPECT_TRUE(delta_reader.empty());
+  EXPECT_THROW(EliasDeltaUtility::decode_next(delta_reader),
+               std::runtime_error);
+}
+
 // test dense-pointers-compression utilities
 TEST(DensePointersUtilityTest, densePointersCompressionTest) {
   /*
@@ -146,6 +176,21 @@ TEST(UtilsTest, utilitiesTest) {
   EXPECT_EQ(Utils::upper_bound(vdarr, 0, 4, 5), 5);
   EXPECT_EQ(Utils::upper_bound(vdarr, 0, 4, 6), 5);
   EXPECT_EQ(Utils::upper_bound(vdarr, 0, 4, 3), 2);
+
+  /*
+    test parallel_for_chunks covers every index exactly once
+  */
+  for (uint n : {0u, 1u, 7u, 1000u}) {
+    for (uint grain : {0u, 1u, 3u, 64u}) {
+      std::vector<uint> hits(n, 0);
+      Utils::parallel_for_chunks(n, 4, grain, [&](uint begin, uint end) {
+        EXPECT_LT(begin, end);
+        EXPECT_LE(end - begin, std::max(1u, grain));
+        for (uint i = begin; i < end; i++) hits[i]++;
+      });
+      EXPECT_EQ(hits, std::vector<uint>(n, 1));
+    }
+  }
 }
 
 // test deltagap compression utility
@@ -221,6 +266,41 @@ TEST(UtilsTest, huffmanTest) {
   EXPECT_EQ(big_values, decoded_values);
 }
 
+// test huffman codes longer than the lookup table and than the length limit
+TEST(UtilsTest, huffmanLongCodesTest) {
+  HuffmanUtility huff;
+  std::vector<uint> decoded_values;
+  BitArray bit_stream;
+
+  // single label
+  std::vector<uint> values{7, 7, 7};
+  huff.encode(values, bit_stream);
+  EXPECT_EQ(bit_stream.size(), 3);
+  huff.decode(bit_stream, decoded_values);
+  EXPECT_EQ(values, decoded_values);
+
+  // fibonacci frequencies make the huffman tree as deep as possible
+  values.clear();
+  uint a = 1, b = 1;
+  for (uint label = 0; label < 27; label++) {
+    for (uint i = 0; i < a; i++) values.push_back(label * 1000);
+    b += a;
+    a = b - a;
+  }
+  srand(42);
+  for (uint i = values.size() - 1; i > 0; i--) {
+    std::swap(values[i], values[uint(rand()) % (i + 1)]);
+  }
+  huff.encode(values, bit_stream);
+  huff.decode(bit_stream, decoded_values);
+  EXPECT_EQ(values, decoded_values);
+
+  uint pos = 0;
+  for (uint i = 0; i < 100; i++) {
+    EXPECT_EQ(huff.decode_next(bit_stream, pos), values[i]);
+  }
+}
+
 // test bitmask utility
 TEST(UtilsTest, bitmaskTest) {
   // init
@@ -247,6 +327,19 @@ TEST(UtilsTest, bitmaskTest) {
   EXPECT_EQ(BitmaskUtility::select(44 /*00110100*/, 2, 8, 0), 4);
   EXPECT_EQ(BitmaskUtility::select(44 /*00110100*/, 5, 8, 0),
             BitmaskUtility::kWordSize);
+
+  // test 64-bit in-word select
+  using Mask64 = WordBitmaskUtility<uint64_t>;
+  uint64_t mask = 0x8000000100000044ULL;
+  EXPECT_EQ(Mask64::select(mask, 0), 2);
+  EXPECT_EQ(Mask64::select(mask, 1), 6);
+  EXPECT_EQ(Mask64::select(mask, 2), 32);
+  EXPECT_EQ(Mask64::select(mask, 3), 63);
+  EXPECT_EQ(Mask64::select(mask, 4), 64);
+  EXPECT_EQ(Mask64::select(~uint64_t(0), 63), 63);
+  for (uint i = 0; i < 64; i++) {
+    EXPECT_EQ(Mask64::select(uint64_t(1) << i, 0), i);
+  }
 }
 }  // namespace test
 }  // namespace lib
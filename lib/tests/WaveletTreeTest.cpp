@@ -1,9 +1,11 @@
+#include <map>
 #include <memory>
 #include <unordered_map>
 
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 // #include "lib/HuffmanWaveletTree.h"
+#include "lib/WaveletMatrix.h"
 #include "lib/WaveletTree.h"
 #include "lib/WaveletTreeInterface.h"
 #include "lib/utils/Utils.h"
@@ -89,7 +91,8 @@ void run_range_count_tests(WaveletTreeInterface &tree) {
   // 1";
 }
 
-void run_range_next_value_pos_tests(WaveletTree &tree) {
+template <typename WaveletTreeType>
+void run_range_next_value_pos_tests(WaveletTreeType &tree) {
   std::unordered_map<uint, uint> f;
   std::vector<uint> vet;
   // std::unique_ptr<std::vector<uint>> vet_ptr(
@@ -111,7 +114,8 @@ void run_range_next_value_pos_tests(WaveletTree &tree) {
   }
 }
 
-void run_range_report_tests(WaveletTree &tree) {
+template <typename WaveletTreeType>
+void run_range_report_tests(WaveletTreeType &tree) {
   std::unordered_map<uint, uint> r1, r2;
   std::vector<uint> vet;
   // std::unique_ptr<std::vector<uint>> vet_ptr(
@@ -139,6 +143,79 @@ void run_range_report_tests(WaveletTree &tree) {
   }
 }
 
+template <typename WaveletTreeType>
+void run_range_active_values_tests(WaveletTreeType &tree) {
+  std::vector<uint> vet = get_random_array(12, 1, 10);
+  LOG(INFO) << "random_vet for range_active_values test: "
+            << Utils::join(vet.begin(), vet.end(), ",");
+  tree.reset(vet);
+  uint max_value = 7;
+  for (uint l = 0; l < vet.size(); l++) {
+    for (uint m = l; m <= vet.size(); m++) {
+      for (uint r = m; r <= vet.size(); r++) {
+        std::map<uint, uint> before, inside;
+        for (uint i = l; i < m; i++) before[vet[i]]++;
+        for (uint i = m; i < r; i++) inside[vet[i]]++;
+        std::vector<uint> expected, result;
+        for (uint v = 0; v <= max_value; v++) {
+          if ((before[v] & 1) || inside[v]) expected.push_back(v);
+        }
+        tree.range_active_values(l, m, r, max_value, result);
+        EXPECT_EQ(result, expected);
+      }
+    }
+  }
+}
+
+template <typename WaveletMatrixType>
+void run_ranges_active_values_tests(WaveletMatrixType &matrix) {
+  std::vector<uint> vet = get_random_array(200, 1, 30);
+  matrix.reset(vet);
+  uint max_value = 20;
+  for (uint x = 0; x < 20; x++) {
+    // consecutive ranges, some of them empty, sharing their limits
+    std::vector<typename WaveletMatrixType::SplitRange> ranges;
+    std::vector<uint> limits = get_random_array(3 * (x + 1), 0, vet.size());
+    std::sort(limits.begin(), limits.end());
+    for (uint i = 0; i + 2 < limits.size(); i += 3) {
+      ranges.push_back({limits[i], limits[i + 1], limits[i + 2]});
+    }
+    std::vector<std::vector<uint>> result(ranges.size());
+    matrix.ranges_active_values(ranges, max_value, [&](uint k, uint v) {
+      result[k].push_back(v);
+    });
+    for (uint k = 0; k < ranges.size(); k++) {
+      std::vector<uint> expected;
+      matrix.range_active_values(ranges[k].l, ranges[k].m, ranges[k].r,
+                                 max_value, expected);
+      EXPECT_EQ(result[k], expected);
+    }
+  }
+}
+
+template <typename WaveletMatrixType>
+void run_ranges_next_value_pos_tests(WaveletMatrixType &matrix) {
+  std::vector<uint> vet = get_random_array(200, 1, 30);
+  matrix.reset(vet);
+  for (uint x = 0; x < 20; x++) {
+    // consecutive ranges, some of them empty
+    std::vector<uint> bounds = get_random_array(x + 2, 0, vet.size());
+    std::sort(bounds.begin(), bounds.end());
+    for (uint val = 0; val <= 32; val++) {
+      std::vector<uint> positions;
+      matrix.ranges_next_value_pos(bounds, val, positions);
+      ASSERT_EQ(positions.size(), bounds.size() - 1);
+      for (uint k = 0; k + 1 < bounds.size(); k++) {
+        uint expected = bounds[k] < bounds[k + 1]
+                            ? matrix.range_next_value_pos(
+                                  bounds[k], bounds[k + 1] - 1, val)
+                            : bounds[k + 1];
+        EXPECT_EQ(positions[k], expected);
+      }
+    }
+  }
+}
+
 // test WaveletTree
 TEST(WaveletTreeTest, waveletTreeTest) {
   /*
@@ -171,6 +248,133 @@ TEST(WaveletTreeTest, waveletTreeTest) {
 
   // ========= test range_report ==========
   run_range_report_tests(tree);
+
+  // ========= test range_active_values ===
+  run_range_active_values_tests(tree);
+}
+
+// test range decoding and sequential cursors of the WaveletTree
+TEST(WaveletTreeTest, cursorTest) {
+  std::vector<uint> vet = get_random_array(300, 5, 1000);
+  WaveletTree tree(vet);
+
+  std::vector<uint> decoded;
+  tree.decode_range(0, vet.size(), decoded);
+  EXPECT_EQ(decoded, vet);
+  tree.decode_range(37, 211, decoded);
+  EXPECT_EQ(decoded, std::vector<uint>(vet.begin() + 37, vet.begin() + 211));
+  tree.decode_range(50, 50, decoded);
+  EXPECT_TRUE(decoded.empty());
+
+  EXPECT_EQ(std::vector<uint>(tree.begin(), tree.end()), vet);
+  uint i = 100;
+  for (auto it = tree.cursor(i); it != tree.end(); ++it, ++i) {
+    EXPECT_EQ(*it, vet[i]);
+  }
+  EXPECT_EQ(i, vet.size());
+  EXPECT_EQ(tree.to_string(),
+            "WaveletTree: [" + Utils::join(vet.begin(), vet.end(), ",") + "]");
+}
+
+// test WaveletTree built on 64-bit cell bitvectors
+TEST(WaveletTreeTest, waveletTree64Test) {
+  WaveletTree64 tree;
+  std::vector<uint> vet;
+
+  vet = get_random_array(100, 0, 20);
+  run_basic_tests(tree, vet);
+
+  vet = get_random_array(10, UINT32_MAX - 2, UINT32_MAX);
+  run_basic_tests(tree, vet);
+
+  run_range_count_tests(tree);
+  run_range_next_value_pos_tests(tree);
+  run_range_report_tests(tree);
+}
+
+// test WaveletMatrix on both bitvector layouts
+TEST(WaveletTreeTest, waveletMatrixTest) {
+  WaveletMatrix matrix;
+  WaveletMatrix64 matrix64;
+  std::vector<uint> vet;
+
+  vet = get_random_array(100, 0, 20);
+  run_basic_tests(matrix, vet);
+  run_basic_tests(matrix64, vet);
+
+  // test 1-size alphabet
+  vet = get_random_array(10, 3, 3);
+  run_basic_tests(matrix, vet);
+  EXPECT_EQ(matrix.range_next_value_pos(2, 5, 3), 2);
+  EXPECT_EQ(matrix.range_next_value_pos(2, 5, 4), 6);
+
+  // test high alphabet
+  vet = get_random_array(10, UINT32_MAX - 2, UINT32_MAX);
+  run_basic_tests(matrix, vet);
+  run_basic_tests(matrix64, vet);
+
+  run_range_count_tests(matrix);
+  run_range_next_value_pos_tests(matrix);
+  run_range_report_tests(matrix);
+  run_range_count_tests(matrix64);
+  run_range_next_value_pos_tests(matrix64);
+  run_range_report_tests(matrix64);
+  run_range_active_values_tests(matrix);
+  run_range_active_values_tests(matrix64);
+  run_ranges_active_values_tests(matrix);
+  run_ranges_active_values_tests(matrix64);
+  run_ranges_next_value_pos_tests(matrix);
+  run_ranges_next_value_pos_tests(matrix64);
+}
+
+// test the wavelet structures compressing their sparse bitvectors
+TEST(WaveletTreeTest, adaptiveWaveletTest) {
+  AdaptiveWaveletTree tree;
+  AdaptiveWaveletMatrix64 matrix;
+  std::vector<uint> vet = get_random_array(100, 0, 20);
+  run_basic_tests(tree, vet);
+  run_basic_tests(matrix, vet);
+  run_range_count_tests(tree);
+  run_range_next_value_pos_tests(tree);
+  run_range_report_tests(tree);
+  run_range_count_tests(matrix);
+  run_range_next_value_pos_tests(matrix);
+  run_range_active_values_tests(matrix);
+  run_ranges_active_values_tests(matrix);
+  run_ranges_next_value_pos_tests(matrix);
+
+  // skewed values, so most bitvectors are sparse and get compressed
+  vet = get_random_array(20000, 0, 1000);
+  for (uint i = 0; i < vet.size(); i++) vet[i] = vet[i] < 950 ? 7 : vet[i];
+  WaveletMatrix64 plain_matrix(vet);
+  matrix.reset(vet);
+  for (uint i = 0; i < vet.size(); i += 13) {
+    EXPECT_EQ(matrix[i], vet[i]);
+    EXPECT_EQ(matrix.rank(i, vet[i]), plain_matrix.rank(i, vet[i]));
+    EXPECT_EQ(matrix.select(i % 50, vet[i]),
+              plain_matrix.select(i % 50, vet[i]));
+  }
+  EXPECT_LT(matrix.measure_memory(), plain_matrix.measure_memory());
+}
+
+// test the multi-threaded construction against the sequential one
+TEST(WaveletTreeTest, parallelBuildTest) {
+  std::vector<uint> vet = get_random_array(1 << 17, 0, 1000);
+  WaveletTree tree, parallel_tree;
+  WaveletMatrix64 matrix, parallel_matrix;
+  tree.reset(vet);
+  parallel_tree.reset(std::vector<uint>(vet), 4);
+  matrix.reset(vet);
+  parallel_matrix.reset(std::vector<uint>(vet), 4);
+
+  for (uint i = 0; i < vet.size(); i += 7) {
+    EXPECT_EQ(parallel_tree[i], vet[i]);
+    EXPECT_EQ(parallel_matrix[i], vet[i]);
+    EXPECT_EQ(parallel_tree.rank(i, vet[i]), tree.rank(i, vet[i]));
+    EXPECT_EQ(parallel_matrix.rank(i, vet[i]), matrix.rank(i, vet[i]));
+  }
+  EXPECT_EQ(parallel_tree.measure_memory(), tree.measure_memory());
+  EXPECT_EQ(parallel_matrix.measure_memory(), matrix.measure_memory());
 }
 
 // [DEPRECATED]
@@ -0,0 +1,23 @@
+#pragma once
+
+namespace compact {
+namespace lib {
+
+/*
+  Policy for the argument checks on the query paths: array indices, mask
+  positions and intervals, vertices and time intervals of the graphs.
+
+  By default the checks are on and throw std::runtime_error on invalid
+  arguments. Defining COMPACT_UNCHECKED (bazel --config=release) compiles them
+  out, so the queries run branch-minimal code and invalid arguments are
+  undefined behaviour. Checks on the input data itself, such as a code failing
+  to decode or an invalid construction parameter, are kept either way.
+*/
+#ifdef COMPACT_UNCHECKED
+constexpr bool kCheckedAccess = false;
+#else
+constexpr bool kCheckedAccess = true;
+#endif
+
+}  // namespace lib
+}  // namespace compact
@@ -1,6 +1,15 @@
 #pragma once
 
+#include <stdint.h>
+
+#include <string>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
 #include "glog/logging.h"
+#include "lib/utils/AccessPolicy.h"
 
 namespace compact {
 namespace lib {
@@ -27,21 +36,7 @@ class BitmaskUtility {
   }
 
   static uint select(uint mask, uint i, uint prefix_size = kWordSize,
-                     uint bit_value = 1) {
-    if (!prefix_size) {
-      return 0;
-    }
-    bit_value %= 2;
-    prefix_size = std::min(prefix_size, kWordSize);
-    if (!bit_value) {
-      mask = get_mask_prefix(~mask, prefix_size - 1);
-    }
-    if (i >= popcount(mask)) return kWordSize;
-    while (i--) {
-      mask -= mask & (-mask);  // remove LSB
-    }
-    return ctz(mask);
-  }
+                     uint bit_value = 1);
 
   // return the amount of bits until the most-significant 1
   static uint count_bits(uint mask) { return kWordSize - clz(mask); }
@@ -78,6 +73,7 @@ class BitmaskUtility {
   static uint get_full_ones(uint n) { return uint((1LL << n) - 1LL); }
 
   static void check_interval(uint l, uint r) {
+    if (!kCheckedAccess) return;
     if (l > r) {
       throw std::runtime_error(
           std::string() + "Invalid mask interval, l = " + std::to_string(l) +
@@ -91,7 +87,7 @@ class BitmaskUtility {
   }
 
   static void check_index(uint i) {
-    if (i >= kWordSize) {
+    if (kCheckedAccess && i >= kWordSize) {
       throw std::runtime_error(std::string() + "Invalid mask index " +
                                std::to_string(i) + ", should be < than " +
                                std::to_string(kWordSize));
@@ -108,5 +104,121 @@ class BitmaskUtility {
   }
 };
 
+/*
+  Mask operations over the storage word of the compact arrays. WordType is
+  either uint (32-bit cells) or uint64_t (64-bit cells).
+*/
+template <typename WordType>
+class WordBitmaskUtility {
+ public:
+  // sizes measured in bits
+  static constexpr uint kWordSize = sizeof(WordType) * 8;
+
+  static uint popcount(WordType mask) {
+    return kWordSize == 64 ? __builtin_popcountll(mask)
+                           : __builtin_popcount(mask);
+  }
+
+  static uint ctz(WordType mask) {
+    return kWordSize == 64 ? __builtin_ctzll(mask) : __builtin_ctz(mask);
+  }
+
+  static uint clz(WordType mask) {
+    return kWordSize == 64 ? __builtin_clzll(mask) : __builtin_clz(mask);
+  }
+
+  /*
+    position of the i-th (0-indexed) active bit of the mask, or kWordSize if
+    the mask has at most i active bits.
+
+    Uses pdep/tzcnt when compiled with BMI2 support, otherwise finds the byte
+    holding the answer with broadword byte counters and finishes inside it.
+  */
+  static uint select(WordType mask, uint i) {
+    if (i >= popcount(mask)) return kWordSize;
+    uint64_t x = mask;
+#ifdef __BMI2__
+    return __builtin_ctzll(_pdep_u64(uint64_t(1) << i, x));
+#else
+    const uint64_t kOnesStep8 = 0x0101010101010101ULL;
+    const uint64_t kMSBsStep8 = 0x80 * kOnesStep8;
+    uint64_t s = x - ((x >> 1) & 0x5555555555555555ULL);
+    s = (s & 0x3333333333333333ULL) + ((s >> 2) & 0x3333333333333333ULL);
+    s = (s + (s >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    // byte b holds the number of active bits on bytes [0, b]
+    uint64_t prefix = s * kOnesStep8;
+    // MSB of byte b is active iff prefix on byte b is <= i
+    uint64_t le = ((i * kOnesStep8 | kMSBsStep8) - prefix) & kMSBsStep8;
+    uint byte = __builtin_popcountll(le);
+    if (byte) i -= (prefix >> (8 * (byte - 1))) & 0xFF;
+    uint bits = (x >> (8 * byte)) & 0xFF;
+    while (i--) bits &= bits - 1;  // remove LSB, at most 7 times
+    return 8 * byte + __builtin_ctz(bits);
+#endif
+  }
+
+  static WordType clear_mask_interval(WordType mask, uint l, uint r) {
+    check_interval(l, r);
+    return mask ^ get_mask_interval(mask, l, r);
+  }
+
+  /*
+    get only the bits on the interval [l,r] active
+  */
+  static WordType get_mask_interval(WordType mask, uint l, uint r) {
+    check_interval(l, r);
+    if (l == 0) return get_mask_prefix(mask, r);
+    return get_mask_prefix(mask, r) ^ get_mask_prefix(mask, l - 1);
+  }
+
+  /*
+    get the mask bits until index i
+  */
+  static WordType get_mask_prefix(WordType mask, uint i) {
+    check_index(i);
+    return mask & get_full_ones(i + 1);
+  }
+
+  static WordType get_full_ones(uint n) {
+    return n >= kWordSize ? ~WordType(0) : (WordType(1) << n) - 1;
+  }
+
+  static void check_interval(uint l, uint r) {
+    if (!kCheckedAccess) return;
+    if (l > r) {
+      throw std::runtime_error(
+          std::string() + "Invalid mask interval, l = " + std::to_string(l) +
+          " should be < than r = " + std::to_string(r));
+    }
+    if ((r - l + 1) > kWordSize) {
+      throw std::runtime_error(std::string() + "Invalid mask interval (" +
+                               std::to_string(l) + "," + std::to_string(r) +
+                               "). Should fit in a " +
+                               std::to_string(kWordSize) + "bit word");
+    }
+  }
+
+  static void check_index(uint i) {
+    if (kCheckedAccess && i >= kWordSize) {
+      throw std::runtime_error(std::string() + "Invalid mask index " +
+                               std::to_string(i) + ", should be < than " +
+                               std::to_string(kWordSize));
+    }
+  }
+};
+
+inline uint BitmaskUtility::select(uint mask, uint i, uint prefix_size,
+                                   uint bit_value) {
+  if (!prefix_size) {
+    return 0;
+  }
+  bit_value %= 2;
+  prefix_size = std::min(prefix_size, kWordSize);
+  if (!bit_value) {
+    mask = get_mask_prefix(~mask, prefix_size - 1);
+  }
+  return WordBitmaskUtility<uint>::select(mask, i);
+}
+
 }  // namespace lib
 }  // namespace compact
@@ -68,6 +68,14 @@ class DeltaGapUtility {
     return values;
   }
 
+  /*
+    Given the value preceding a position and the deltaGap code on that
+    position, return the original value on it.
+  */
+  uint decode_next(uint previous, uint code) const {
+    return (int)code - offset + previous;
+  }
+
   uint measure_memory() const { return sizeof(offset); }
 
  private:
@@ -6,6 +6,7 @@
 
 #include "glog/logging.h"
 #include "lib/BitArray.h"
+#include "lib/BitStream.h"
 #include "lib/utils/BitmaskUtility.h"
 
 namespace compact {
@@ -21,11 +22,10 @@ class DensePointersUtility {
     }
 
     uint sz = get_code_length(val);
-    BitArray arr;
-    arr.assign(sz, 0);
-    for (uint i = 0; i < sz; i++) {
-      arr.write(i, (val >> i) & 1);
-    }
+    BitArray arr(sz);
+    BitWriter writer(arr);
+    writer.write(val, sz);
+    writer.flush();
     return arr;
   }
 
@@ -34,17 +34,13 @@ class DensePointersUtility {
   template <typename ArrayType>
   static BitArray get_array_code(const ArrayType& values) {
     uint totalSize = get_array_code_length(values);
-    BitArray arr;
-    arr.assign(totalSize, 0);
-    for (uint i = 0, arridx = 0; i < values.size(); i++) {
-      uint val = values[i];
-      uint sz = get_code_length(val);
-
-      for (uint j = 0; j < sz; j++) {
-        arr.write(arridx, (val >> j) & 1);
-        arridx++;
-      }
+    BitArray arr(totalSize);
+    BitWriter writer(arr);
+    for (uint i = 0; i < values.size(); i++) {
+      // the most significant bit is implicit, write drops it
+      writer.write(values[i], get_code_length(values[i]));
     }
+    writer.flush();
     return arr;
   }
 
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <math.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "glog/logging.h"
+#include "lib/BitArray.h"
+#include "lib/BitStream.h"
+#include "lib/utils/BitmaskUtility.h"
+
+namespace compact {
+namespace lib {
+
+/*
+  Elias delta codes: the number of bits of the value in gama format, followed
+  by the value without its most significant bit. Like on GamaUtility, values
+  are incremented before being encoded so zero can be represented.
+  Example: 6 -> 7 (111, 3 bits) -> 011 11 (gama of 3 + "11")
+
+  Shorter than gama codes for values above 31, at the cost of a second read
+  when decoding.
+*/
+class EliasDeltaUtility {
+ public:
+  static BitArray get_code(uint val) {
+    val++;
+    BitArray arr(get_code_length(val));
+    BitWriter writer(arr);
+    write_code(writer, val);
+    writer.flush();
+    return arr;
+  }
+
+  /*
+    Get the bit array representing the binary stream in delta-compression
+    format for a given array of values.
+  */
+  template <typename ArrayType>
+  static BitArray get_array_code(const ArrayType& values) {
+    BitArray arr(get_array_code_length(values));
+    BitWriter writer(arr);
+    for (uint i = 0; i < values.size(); i++) {
+      write_code(writer, values[i] + 1);
+    }
+    writer.flush();
+    return arr;
+  }
+
+  /*
+    Given a bit array in delta format and a starting point, return the value
+    decoded from the given position, updating the given pointer to the
+    starting position of the next value.
+  */
+  static uint decode_next(const BitArray& arr, uint& start) {
+    BitReader reader(arr, std::min(start, arr.size()));
+    uint result = decode_next(reader);
+    start = reader.position();
+    return result;
+  }
+
+  // decode the value at the current position of the reader and consume it
+  static uint decode_next(BitReader& reader) {
+    uint zeroes = reader.count_zeros();
+    if (zeroes >= BitmaskUtility::int_log(BitReader::kMaxCodeLength) + 1 ||
+        reader.empty() || reader.size() - reader.position() < 2 * zeroes + 1) {
+      throw std::runtime_error("Decoding failed, invalid starting point.");
+    }
+    reader.skip(zeroes);
+    uint bits = reader.read_reversed(zeroes + 1);
+    if (bits > BitReader::kMaxCodeLength ||
+        reader.size() - reader.position() < bits - 1) {
+      throw std::runtime_error("Decoding failed, invalid starting point.");
+    }
+    uint val = reader.read_reversed(bits - 1) | (1u << (bits - 1));
+    return val - 1;
+  }
+
+ private:
+  // write the delta code of val (already incremented)
+  static void write_code(BitWriter& writer, uint val) {
+    uint bits = BitmaskUtility::count_bits(val);
+    uint bits_length = BitmaskUtility::count_bits(bits);
+    writer.write_zeros(bits_length - 1);
+    writer.write_reversed(bits, bits_length);
+    writer.write_reversed(val, bits - 1);
+  }
+
+  /*
+    Return the length of the delta code representing the given value
+    Example: code length of 7 is 5
+    7 -> 01111
+  */
+  static uint get_code_length(uint val) {
+    uint bits = BitmaskUtility::count_bits(val);
+    return 2 * BitmaskUtility::count_bits(bits) - 1 + bits - 1;
+  }
+
+  /*
+    Return the sum of code lengths for an array of values
+  */
+  template <typename ArrayType>
+  static uint get_array_code_length(const ArrayType& arr) {
+    uint sum = 0;
+    for (uint i = 0; i < arr.size(); i++) {
+      sum += get_code_length(arr[i] + 1);
+    }
+    return sum;
+  }
+};
+
+}  // namespace lib
+}  // namespace compact
@@ -2,10 +2,12 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "glog/logging.h"
 #include "lib/BitArray.h"
+#include "lib/BitStream.h"
 #include "lib/utils/BitmaskUtility.h"
 
 namespace compact {
@@ -20,11 +22,10 @@ class GamaUtility {
   static BitArray get_code(uint val) {
     val++;
     uint sz = get_code_length(val);
-    BitArray arr;
-    arr.assign(sz, 0);
-    for (uint i = sz >> 1; i < sz; i++) {
-      arr.write(i, (val >> (sz - i - 1)) & 1);
-    }
+    BitArray arr(sz);
+    BitWriter writer(arr);
+    write_code(writer, val, sz);
+    writer.flush();
     return arr;
   }
 
@@ -35,18 +36,13 @@ class GamaUtility {
   template <typename ArrayType>
   static BitArray get_array_code(const ArrayType& values) {
     uint totalSize = get_array_code_length(values);
-    BitArray arr;
-    arr.assign(totalSize, 0);
-    for (uint i = 0, arridx = 0; i < values.size(); i++) {
+    BitArray arr(totalSize);
+    BitWriter writer(arr);
+    for (uint i = 0; i < values.size(); i++) {
       uint val = values[i] + 1;
-      uint sz = get_code_length(val);
-
-      arridx += sz >> 1;
-      for (uint j = sz >> 1; j < sz; j++) {
-        arr.write(arridx, (val >> (sz - j - 1)) & 1);
-        arridx++;
-      }
+      write_code(writer, val, get_code_length(val));
     }
+    writer.flush();
     return arr;
   }
 
@@ -62,24 +58,37 @@ class GamaUtility {
     bit chunk decoded: "011"
   */
   static uint decode_next(const BitArray& arr, uint& start) {
-    uint result = 0;
-    int count_zeroes = 0;
-    int delta = 1;
-
-    for (uint& i = start; i < arr.size(); i++) {
-      if (count_zeroes < 0) break;
-      if (arr[i] == 1) delta = -1;
-      count_zeroes += delta;
+    BitReader reader(arr, std::min(start, arr.size()));
+    uint result = decode_next(reader);
+    start = reader.position();
+    return result;
+  }
 
-      result = (result << 1) | arr[i];
-    }
-    if (count_zeroes != -1) {
+  /*
+    Decode the value at the current position of the reader and consume it.
+    The zeroes are counted on the 64-bit window of the reader and the value
+    is read at once, so the cost does not depend on the code length.
+  */
+  static uint decode_next(BitReader& reader) {
+    uint zeroes = reader.count_zeros();
+    if (zeroes >= BitReader::kMaxCodeLength || reader.empty() ||
+        reader.size() - reader.position() < 2 * zeroes + 1) {
       throw std::runtime_error("Decoding failed, invalid starting point.");
     }
-    return result - 1;
+    reader.skip(zeroes);
+    return reader.read_reversed(zeroes + 1) - 1;
   }
 
  private:
+  /*
+    Write the sz bits gama code of val (already incremented): sz / 2 zeroes
+    followed by val, most significant bit first
+  */
+  static void write_code(BitWriter& writer, uint val, uint sz) {
+    writer.write_zeros(sz >> 1);
+    writer.write_reversed(val, (sz >> 1) + 1);
+  }
+
   /*
     Return the length of the gama code representing the given value
     Example: code length of 3 is 5
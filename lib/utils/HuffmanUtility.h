@@ -9,6 +9,7 @@
 
 #include "glog/logging.h"
 #include "lib/BitArray.h"
+#include "lib/BitStream.h"
 #include "lib/FixedSizeArray.h"
 #include "lib/HuffmanTree.h"
 
@@ -17,9 +18,9 @@ namespace lib {
 
 class HuffmanUtility {
  public:
-  using FrequencyContainer = HuffmanTree::FrequencyContainer;
-  using CodeContainer = HuffmanTree::CodeContainer;
-  using ContainerType = HuffmanTree::ContainerType;
+  using FrequencyContainer = CanonicalHuffmanTree::FrequencyContainer;
+  using CodeContainer = CanonicalHuffmanTree::CodeContainer;
+  using ContainerType = CanonicalHuffmanTree::ContainerType;
 
   HuffmanUtility() {}
 
@@ -42,6 +43,17 @@ class HuffmanUtility {
     return;
   }
 
+  /*
+    decode the value starting at position idx of the bit_stream, moving idx to
+    the beginning of the next one
+  */
+  uint decode_next(const BitArray& bit_stream, uint& idx) const {
+    return tree.decode_next(bit_stream, idx);
+  }
+
+  // decode the value at the current position of the reader, consuming it
+  uint decode_next(BitReader& reader) const { return tree.decode_next(reader); }
+
   uint measure_memory() const { return tree.measure_memory(); }
 
   template <typename ArrayType>
@@ -54,7 +66,7 @@ class HuffmanUtility {
   }
 
  private:
-  HuffmanTree tree;
+  CanonicalHuffmanTree tree;
 
   /*
     build array of pairs (value, frequency), sorted by value
@@ -100,22 +112,12 @@ class HuffmanUtility {
     // LOG(INFO) << "total_length: " << total_length;
 
     bit_stream.resize(total_length);
-    uint idx = 0;
+    BitWriter writer(bit_stream);
     for (auto val : values) {
-      write_code(bit_stream, idx, codes.at(val).first, codes.at(val).second);
-    }
-  }
-
-  /*
-    write a code on the bit_stream
-
-    TODO: change to bit_stream.write_interval()
-  */
-  static void write_code(BitArray& bit_stream, uint& idx, uint code,
-                         uint code_size) {
-    for (uint i = 0; i < code_size; i++) {
-      bit_stream.write(idx++, 1 & (code >> i));
+      auto& code = codes.at(val);
+      writer.write(code.first, code.second);
     }
+    writer.flush();
   }
 };
 
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "glog/logging.h"
 
@@ -55,6 +59,53 @@ class Utils {
     return answer;
   }
 
+  /*
+    Call f(i) for every i in [0, n) using up to the given number of threads.
+    Indices are handed out one at a time, so uneven tasks are balanced, and f
+    must only touch state owned by its index.
+  */
+  template <typename Function>
+  static void parallel_for(uint n, uint threads, const Function& f) {
+    parallel_for_chunks(n, threads, 1, [&](uint begin, uint end) {
+      for (uint i = begin; i < end; i++) f(i);
+    });
+  }
+
+  /*
+    Call f(begin, end) on the consecutive chunks of up to grain indices that
+    cover [0, n), using up to the given number of threads. A thread done with
+    its chunk takes the next unclaimed one, so skewed chunks are balanced at
+    the cost of one atomic operation per chunk rather than per index. State
+    local to f, such as scratch buffers, is shared by the whole chunk.
+  */
+  template <typename Function>
+  static void parallel_for_chunks(uint n, uint threads, uint grain,
+                                  const Function& f) {
+    grain = std::max(1u, grain);
+    uint chunks = n / grain + (n % grain != 0);
+    threads = std::max(1u, std::min(threads, chunks));
+    auto run_chunk = [&](uint c) {
+      f(c * grain, std::min(n, (c + 1) * grain));
+    };
+    if (threads == 1) {
+      for (uint c = 0; c < chunks; c++) run_chunk(c);
+      return;
+    }
+    std::atomic<uint> next(0);
+    auto worker = [&]() {
+      for (uint c = next++; c < chunks; c = next++) run_chunk(c);
+    };
+    std::vector<std::thread> workers;
+    for (uint t = 1; t < threads; t++) workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers) w.join();
+  }
+
+  // number of threads to use when the caller asks for all of them
+  static uint hardware_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
   template <typename Iterator>
   static std::string join(Iterator begin, Iterator end,
                           const std::string& delim) {
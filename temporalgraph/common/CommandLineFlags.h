@@ -8,4 +8,14 @@ DEFINE_int32(aggregate_epochs, 10,
              "Number of times to run the aggregate operation");
 DEFINE_string(
     output_file, "results.json",
-    "Name of the file that will contain the result of the experiment");
\ No newline at end of file
+    "Name of the file that will contain the result of the experiment");
+DEFINE_bool(wavelet_labels, false,
+            "Store the EveLog labels on wavelet matrices, making has_edge "
+            "logarithmic at the cost of memory");
+DEFINE_int32(checkpoint_rate, 0,
+             "Events between two EveLog active set checkpoints, 0 disables "
+             "them");
+DEFINE_int32(build_threads, 1,
+             "Number of threads used to build the graph representation");
+DEFINE_int32(aggregate_threads, 1,
+             "Number of threads used by the aggregate operation");
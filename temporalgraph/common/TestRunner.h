@@ -18,7 +18,7 @@ class TestRunner {
 
   TestSummary run(const AbstractGraph& graph, uint V, uint E, uint T,
                   uint has_edge_epochs, uint neighbours_epochs,
-                  uint aggregate_epochs) {
+                  uint aggregate_epochs, uint aggregate_threads = 1) {
     TimeCounter edge_c, neigh_c, agg_c;
     LOG(INFO) << "has_edge:";
     for (uint i = 0; i < has_edge_epochs; i++) {
@@ -45,7 +45,7 @@ class TestRunner {
       agg_c.start();
       auto t = get_random_temporal_range(T);
       LOG(INFO) << "t0: " << t.first << ", t1: " << t.second;
-      graph.aggregate(t.first, t.second);
+      graph.aggregate(t.first, t.second, aggregate_threads);
       agg_c.stop();
     }
 
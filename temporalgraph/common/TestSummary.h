@@ -21,6 +21,7 @@ class TestSummary {
    aggregate_time_ms  FLOAT,
    graph_size_kb       INT,
    max_rss_kb         INT,
+   build_rss_kb       INT,
    has_edge_epochs     INT,
    neighbours_epochs   INT,
    aggregate_epochs    INT
@@ -36,6 +37,7 @@ class TestSummary {
     this->edge_counter = edge_counter;
     this->neighbour_counter = neighbour_counter;
     this->aggregate_counter = aggregate_counter;
+    this->build_rss_kb = 0;
   }
 
   void set_remaining_fields(double build_time_ms, uint graph_size_kb,
@@ -49,6 +51,11 @@ class TestSummary {
     this->aggregate_epochs = aggregate_epochs;
   }
 
+  // growth of the peak RSS while building the graph
+  void set_build_rss_kb(uint build_rss_kb) {
+    this->build_rss_kb = build_rss_kb;
+  }
+
   //   std::string to_csv() {
   //     char str[1000];
   //     sprintf(str, "%s,%d,%d,%d,%lf,%lf,%lf,%lf,")
@@ -69,14 +76,15 @@ class TestSummary {
             "      \"aggregate_time_ms\": %.4lf,\n"
             "      \"graph_size_kb\": %d,\n"
             "      \"max_rss_kb\": %d,\n"
+            "      \"build_rss_kb\": %d,\n"
             "      \"has_edge_epochs\": %d,\n"
             "      \"neighbours_epochs\": %d,\n"
             "      \"aggregate_epochs\": %d\n"
             "}",
             graph_type.c_str(), V, E, T, build_time_ms, edge_counter.get_mean(),
             neighbour_counter.get_mean(), aggregate_counter.get_mean(),
-            graph_size_kb, max_rss_kb, has_edge_epochs, neighbours_epochs,
-            aggregate_epochs);
+            graph_size_kb, max_rss_kb, build_rss_kb, has_edge_epochs,
+            neighbours_epochs, aggregate_epochs);
     return std::string(str);
   }
 
@@ -87,6 +95,7 @@ class TestSummary {
   uint T;
   uint graph_size_kb;
   uint max_rss_kb;
+  uint build_rss_kb;
   uint has_edge_epochs;
   uint neighbours_epochs;
   uint aggregate_epochs;
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <functional>
+#include <mutex>
 #include <utility>
 #include <vector>
 
+#include "lib/utils/Utils.h"
 #include "temporalgraph/common/graph/GraphUtils.h"
 
 namespace compact {
@@ -25,6 +28,25 @@ class AbstractGraph {
 
   virtual VertexContainer neighbours(uint u, uint start, uint end) const = 0;
 
+  /*
+    Returns the vertices u with an edge (u, v) active during that time
+    interval, in increasing order. Without a reverse index, every vertex is
+    checked with has_edge.
+  */
+  virtual VertexContainer reverse_neighbours(uint v, uint start,
+                                             uint end) const {
+    VertexContainer answer;
+    for (uint u = 0; u < this->n; u++) {
+      if (has_edge(u, v, start, end)) answer.push_back(u);
+    }
+    return answer;
+  }
+
+  // number of reverse neighbours of v on that time interval
+  virtual uint in_degree(uint v, uint start, uint end) const {
+    return reverse_neighbours(v, start, end).size();
+  }
+
   virtual std::string get_name() const = 0;
 
   virtual uint measure_memory() const = 0;
@@ -33,24 +55,87 @@ class AbstractGraph {
 
   uint size() const { return this->n; }
 
-  // returns the graph's edges that were active on that time interval
-  EdgeContainer aggregate(uint start, uint end) const {
+  /*
+    Receives the edges of aggregate, one batch of consecutive vertices at a
+    time, and may take the batch over by swapping it. Calls are never
+    concurrent.
+  */
+  using EdgeSink = std::function<void(EdgeContainer&)>;
+
+  /*
+    Returns the graph's edges that were active on that time interval.
+
+    The vertices are queried on up to the given number of threads, in chunks
+    of kAggregateChunkSize, each chunk collecting its edges on its own buffer
+    (see aggregate_range), so the queries must be safe to run concurrently.
+    If ordered, the buffers are concatenated in vertex order and the result
+    is the same for any number of threads, otherwise they are appended as
+    their chunks finish.
+  */
+  EdgeContainer aggregate(uint start, uint end, uint threads = 1,
+                          bool ordered = true) const {
     EdgeContainer edges;
-    VertexContainer tmpVertices;
-    for (uint i = 0; i < this->n; i++) {
-      // LOG(INFO) << "aggregate: i = " << i << ", n = " << this->n;
-      tmpVertices.clear();
-      tmpVertices = this->neighbours(i, start, end);
-      // LOG(INFO) << "result: " << tmpVertices.size() << " neighbours";
-
-      for (uint j = 0; j < tmpVertices.size(); j++) {
-        edges.push_back(Edge(i, tmpVertices[j]));
-      }
-    }
+    aggregate(
+        start, end,
+        [&](EdgeContainer& chunk) {
+          if (edges.empty()) {
+            edges.swap(chunk);
+          } else {
+            edges.insert(edges.end(), chunk.begin(), chunk.end());
+          }
+        },
+        threads, ordered);
     return edges;
   }
 
+  /*
+    Same as above, streaming the edges to sink instead. Unordered, each chunk
+    is handed over as soon as it is done, so its buffer is released right
+    away.
+  */
+  void aggregate(uint start, uint end, const EdgeSink& sink,
+                 uint threads = 1, bool ordered = true) const {
+    uint n_chunks = (this->n + kAggregateChunkSize - 1) / kAggregateChunkSize;
+    // a single thread does the chunks in order, no need to keep them
+    bool buffered = ordered && threads > 1;
+    std::vector<EdgeContainer> chunks(buffered ? n_chunks : 0);
+    std::mutex sink_mutex;
+    lib::Utils::parallel_for_chunks(
+        this->n, threads, kAggregateChunkSize, [&](uint begin, uint last) {
+          EdgeContainer edges;
+          aggregate_range(begin, last, start, end, edges);
+          if (buffered) {
+            chunks[begin / kAggregateChunkSize] = std::move(edges);
+          } else {
+            std::lock_guard<std::mutex> lock(sink_mutex);
+            sink(edges);
+          }
+        });
+    for (auto& chunk : chunks) {
+      sink(chunk);
+      EdgeContainer().swap(chunk);
+    }
+  }
+
  protected:
+  // vertices handed to a thread at a time by aggregate
+  static constexpr uint kAggregateChunkSize = 1024;
+
+  /*
+    Append to edges the edges of the vertices [first, last) active on the
+    [start, end] time interval, vertex by vertex. aggregate calls it on each
+    chunk, concurrently when running on several threads. Representations
+    able to answer a whole range of vertices at once override it.
+  */
+  virtual void aggregate_range(uint first, uint last, uint start, uint end,
+                               EdgeContainer& edges) const {
+    for (uint u = first; u < last; u++) {
+      for (Vertex v : this->neighbours(u, start, end)) {
+        edges.push_back(Edge(u, v));
+      }
+    }
+  }
+
   uint n;
 };
 
@@ -54,7 +54,7 @@ class AdjacencyList : public AbstractGraph {
   TemporalAdjacencyList adj;
 
   void check_vertex(uint u) const {
-    if (u >= n) {
+    if (lib::kCheckedAccess && u >= n) {
       throw std::runtime_error("Vertex index is out of bounds.");
     }
   }
@@ -7,7 +7,7 @@
 
 #include "glog/logging.h"
 #include "lib/BitVector.h"
-#include "lib/WaveletTree.h"
+#include "lib/WaveletMatrix.h"
 #include "temporalgraph/common/Utils.h"
 #include "temporalgraph/common/graph/AbstractGraph.h"
 #include "temporalgraph/common/graph/GraphUtils.h"
@@ -31,20 +31,33 @@ class CAS : public AbstractGraph {
 
   CAS() {}
 
-  CAS(uint n) {
-    this->n = n;
-    TemporalAdjacencyList adj(n);
-    build(adj);
-  }
+  CAS(uint n) { reset(TemporalAdjacencyList(n)); }
+
+  CAS(const TemporalAdjacencyList& adj) { reset(adj); }
 
-  CAS(TemporalAdjacencyList adj) {
-    this->n = adj.size();
-    build(adj);
+  CAS(TemporalAdjacencyList&& adj) { reset(std::move(adj)); }
+
+  /*
+    Rebuild from the given adjacency list. The wavelet matrix is built using
+    up to the given number of threads.
+  */
+  void reset(const TemporalAdjacencyList& adj, uint threads = 1) {
+    std::vector<uint> sequence;
+    build_sequence(adj, sequence);
+    wavelet.reset(std::move(sequence), threads);
   }
 
-  void reset(TemporalAdjacencyList adj) {
-    this->n = adj.size();
-    build(adj);
+  /*
+    Same as above, taking ownership of the adjacency list so it is released
+    before the wavelet matrix is built
+  */
+  void reset(TemporalAdjacencyList&& adj, uint threads = 1) {
+    std::vector<uint> sequence;
+    {
+      TemporalAdjacencyList input(std::move(adj));
+      build_sequence(input, sequence);
+    }
+    wavelet.reset(std::move(sequence), threads);
   }
 
   // returns whether there is an edge (u, v) active at some moment during that
@@ -85,48 +98,52 @@ class CAS : public AbstractGraph {
 
   // returns neighbours of vertex u on the [start, end] time interval
   VertexContainer neighbours(uint u, uint start, uint end) const override {
+    VertexContainer answer;
+    neighbours(u, start, end, answer);
+    return answer;
+  }
+
+  /*
+    Append the neighbours of vertex u on the [start, end] time interval to
+    answer, in increasing order.
+  */
+  void neighbours(uint u, uint start, uint end, VertexContainer& answer) const {
     start += offset;
     end += offset;
-    // LOG(INFO) << "start (+offset): " << start << ", end (+offset)" << end;
-    // u's range on the wavelet tree is [i,j]
+    // u's range on the wavelet tree is [i,j)
     uint i = bitv.rank(bitv.select(u, 1), 0);
-    // LOG(INFO) << "select = " << bitv.select(u, 1) << ", i: " << i;
-    uint j = bitv.rank(bitv.select(u + 1, 1), 0) - 1;
-    // LOG(INFO) << "select = " << bitv.select(u + 1, 1) << ", j: " << j;
-
-    uint kbegin = wavelet.range_next_value_pos(i, j, start);
-    // LOG(INFO) << "kbegin: " << kbegin;
-    uint kend = wavelet.range_next_value_pos(i, j, end + 1);
+    uint j = bitv.rank(bitv.select(u + 1, 1), 0);
+    if (j <= i) return;
 
-    // LOG(INFO) << "i = " << i << " j = " << j << " kbegin = " << kbegin
-    //           << " kend = " << kend << ", u = " << u << ", v = " << v;
+    uint kbegin = wavelet.range_next_value_pos(i, j - 1, start);
+    uint kend = wavelet.range_next_value_pos(i, j - 1, end + 1);
 
-    std::unordered_map<uint, uint> report_before;
-    std::unordered_map<uint, uint> report_interval;
-    if (i != kbegin) wavelet.range_report(i, kbegin - 1, report_before);
-    if (i != kend) wavelet.range_report(kbegin, kend - 1, report_interval);
+    // a vertex is active if it has odd frequency before the time interval,
+    // or if it appears inside of it. Timestamps are all >= n
+    wavelet.range_active_values(i, kbegin, kend, n - 1, answer);
+  }
 
+  /*
+    Returns the vertices u with an edge (u, v) active on the [start, end]
+    time interval, in increasing order. The occurrences of v on the sequence
+    are grouped by source vertex: the first one of each group is found with a
+    select on v and mapped to its source through bitv, and ranks of v on the
+    source's range tell whether the edge is active, as in has_edge.
+  */
+  VertexContainer reverse_neighbours(uint v, uint start,
+                                     uint end) const override {
     VertexContainer answer;
-    std::unordered_map<uint, bool> chosen;
-    for (auto& p : report_before) {
-      uint v = p.first, f = p.second;
-      if (v >= n) continue;
-      if ((f & 1) ||
-          report_interval.count(v)) {  // odd frequency before the time interval
-        answer.push_back(v);
-        chosen[v] = true;
-      }
-    }
-    for (auto& p : report_interval) {
-      uint v = p.first, f = p.second;
-      if (v >= n) continue;
-      if (!chosen.count(v) && f > 0) {  // vertex appears inside the interval
-        answer.push_back(v);
-      }
-    }
+    for_each_reverse_neighbour(v, start, end,
+                               [&](uint u) { answer.push_back(u); });
     return answer;
   }
 
+  uint in_degree(uint v, uint start, uint end) const override {
+    uint degree = 0;
+    for_each_reverse_neighbour(v, start, end, [&](uint) { degree++; });
+    return degree;
+  }
+
   std::string get_name() const override { return "CAS"; }
 
   uint measure_memory() const override {
@@ -139,80 +156,129 @@ class CAS : public AbstractGraph {
     return line;
   }
 
- private:
-  uint offset;
-  lib::BitVector bitv;
-  lib::WaveletTree wavelet;
+ protected:
+  /*
+    The sequences of the vertices [first, last) are consecutive, so their
+    boundaries come from one select per vertex, the splits at the start and
+    end of the time interval from one batched descent each, and their active
+    neighbours from a single traversal of the wavelet matrix covering all of
+    them, instead of one neighbours query each.
+  */
+  void aggregate_range(uint first, uint last, uint start, uint end,
+                       EdgeContainer& edges) const override {
+    if (first >= last) return;
+    // vertex u's range on the wavelet matrix is [bounds[k], bounds[k + 1]),
+    // with k = u - first
+    std::vector<uint> bounds(last - first + 1);
+    for (uint u = first; u <= last; u++) {
+      bounds[u - first] = bitv.select(u, 1) - u;
+    }
+    // each range is split at the start of the time interval and cut at its
+    // end
+    std::vector<uint> starts, ends;
+    wavelet.ranges_next_value_pos(bounds, start + offset, starts);
+    wavelet.ranges_next_value_pos(bounds, end + offset + 1, ends);
+    std::vector<lib::AdaptiveWaveletMatrix64::SplitRange> ranges(last - first);
+    for (uint k = 0; k < ranges.size(); k++) {
+      ranges[k] = {bounds[k], starts[k], ends[k]};
+    }
 
-  void build(TemporalAdjacencyList adj) {
-    n = adj.size();
-    offset = n;  // value to be added to every timestamp
-    // LOG(INFO) << "Build CAS, adj.size() = " << adj.size();
-    EventContainer events;
-    build_events(adj, events);
-    // LOG(INFO) << "Events (not ordered):" << events;
-    sort_events(adj, events);
-    // LOG(INFO) << "Events (ordered):" << events;
-    std::vector<uint> sizes, sequence;
-    build_sequence(adj, events, sequence, sizes);
-    // LOG(INFO) << "Sequence:" << sequence;
-    build_bitvector(sizes);
-    // LOG(INFO) << "BitVector:" << bitv.to_string();
-    wavelet.reset(sequence);
+    // the neighbours come ordered by value, bucket them by vertex
+    EdgeContainer found;
+    std::vector<uint> bucket(last - first + 1, 0);
+    wavelet.ranges_active_values(ranges, n - 1, [&](uint k, uint v) {
+      found.push_back(Edge(k, v));
+      bucket[k + 1]++;
+    });
+    std::partial_sum(bucket.begin(), bucket.end(), bucket.begin());
+    size_t base = edges.size();
+    edges.resize(base + found.size());
+    for (const Edge& e : found) {
+      edges[base + bucket[e.first]++] = Edge(first + e.first, e.second);
+    }
   }
 
-  // transforms the adjacency list in an event sequence
-  // with timestamps increased by n to avoid conflict
-  // between timestamps and vertices numbers
-  void build_events(const TemporalAdjacencyList adj,
-                    EventContainer& events) const {
-    events.clear();
-    for (uint u = 0; u < adj.size(); u++) {
-      for (auto& neighbour : adj[u]) {
-        uint v = neighbour.first;
-        uint tbegin = neighbour.second.first;
-        uint tend = neighbour.second.second;
-        events.push_back({v, tbegin + offset});
-        events.push_back({v, tend + offset});
-      }
+ private:
+  uint offset;
+  // one bit per vertex plus one per sequence element, sparse on most graphs
+  lib::AdaptiveBitVector64 bitv;
+  lib::AdaptiveWaveletMatrix64 wavelet;
+
+  // call f(u) for each reverse neighbour u of v, in increasing order
+  template <typename Function>
+  void for_each_reverse_neighbour(uint v, uint start, uint end,
+                                  const Function& f) const {
+    check_vertex(v);
+    start += offset;
+    end += offset;
+    uint occurrences = wavelet.rank(wavelet.size(), v);
+    for (uint k = 0; k < occurrences;) {
+      uint pos = wavelet.select(k, v);
+      // bitv has pos zeros and u + 1 ones before the zero of position pos
+      uint u = bitv.select(pos, 0) - pos - 1;
+      // u's range on the wavelet matrix is [i, j), v occurs k times before i
+      uint i = bitv.select(u, 1) - u;
+      uint j = bitv.select(u + 1, 1) - (u + 1);
+      uint kbegin = wavelet.range_next_value_pos(i, j - 1, start);
+      uint kend = wavelet.range_next_value_pos(i, j - 1, end + 1);
+      uint rank_begin = wavelet.rank(kbegin, v);
+      // active if it has odd frequency before the time interval, or if it
+      // appears inside of it
+      if (((rank_begin - k) & 1) || wavelet.rank(kend, v) > rank_begin) f(u);
+      k = wavelet.rank(j, v);
     }
   }
 
-  // sort events of same origin vertex by timestamp
-  static void sort_events(const TemporalAdjacencyList adj,
-                          EventContainer& events) {
-    auto start = events.begin();
-    auto end = events.begin();
-    for (uint i = 0; i < adj.size(); i++) {
-      end = start + 2 * adj[i].size();
-      std::sort(start, end, [](Event e1, Event e2) {
-        // order increasingly by time
-        return e1.second < e2.second;
-      });
-      start = end;
+  /*
+    Build the wavelet matrix sequence: for each vertex, its events sorted by
+    time, each distinct timestamp (shifted by n, so it doesn't conflict with
+    the vertices) followed by the neighbours of the events at that time.
+    Also builds the bitvector marking where each vertex's sequence starts.
+  */
+  void build_sequence(const TemporalAdjacencyList& adj,
+                      std::vector<uint>& seq) {
+    n = adj.size();
+    offset = n;  // value to be added to every timestamp
+    size_t max_events = 0, total_events = 0;
+    for (auto& neighbours : adj) {
+      max_events = std::max(max_events, 2 * neighbours.size());
+      total_events += 2 * neighbours.size();
     }
-  }
 
-  // build wavelet_tree sequence as an array
-  static void build_sequence(const TemporalAdjacencyList adj,
-                             EventContainer& events, std::vector<uint>& seq,
-                             std::vector<uint>& sizes) {
+    // at most one timestamp per event
     seq.clear();
-    sizes.clear();
-    uint sz, e_idx = 0;
-    for (uint u = 0; u < adj.size(); u++) {
-      sz = 0;
-      for (uint j = 0; j < 2 * adj[u].size(); j++) {
-        if (j == 0 || events[e_idx].second != events[e_idx - 1].second) {
-          seq.push_back(events[e_idx].second);
-          sz++;
+    seq.reserve(2 * total_events);
+    std::vector<uint> sizes(n);
+    // events of a single vertex, reused for all of them
+    EventContainer events;
+    events.reserve(max_events);
+    for (uint u = 0; u < n; u++) {
+      build_events(adj[u], events);
+      size_t start = seq.size();
+      for (uint j = 0; j < events.size(); j++) {
+        if (j == 0 || events[j].second != events[j - 1].second) {
+          seq.push_back(events[j].second);
         }
-        seq.push_back(events[e_idx].first);
-        sz++;
-        e_idx++;
+        seq.push_back(events[j].first);
       }
-      sizes.push_back(sz);
+      sizes[u] = seq.size() - start;
+    }
+    build_bitvector(sizes);
+  }
+
+  // events of a vertex sorted by time, timestamps increased by offset
+  void build_events(const TemporalNeighbourContainer& neighbours,
+                    EventContainer& events) const {
+    events.clear();
+    for (auto& neighbour : neighbours) {
+      uint v = neighbour.first;
+      events.push_back({v, neighbour.second.first + offset});
+      events.push_back({v, neighbour.second.second + offset});
     }
+    std::sort(events.begin(), events.end(), [](Event e1, Event e2) {
+      // order increasingly by time
+      return e1.second < e2.second;
+    });
   }
 
   // build bitvector indicating where each vertex's sequence start on the
@@ -220,7 +286,7 @@ class CAS : public AbstractGraph {
   void build_bitvector(const std::vector<uint>& sizes) {
     uint sum = sizes.size() + std::accumulate(sizes.begin(), sizes.end(), 0);
     // LOG(INFO) << "sizes = " << sizes << ", sum = " << sum;
-    lib::BitArray bitarr(sum);
+    lib::BitArray64 bitarr(sum);
     for (uint bidx = 0, i = 0; i < sizes.size(); i++) {
       bitarr.write(bidx, 1);
       bidx += sizes[i] + 1;
@@ -229,7 +295,7 @@ class CAS : public AbstractGraph {
   }
 
   void check_vertex(uint u) const {
-    if (u >= n) {
+    if (lib::kCheckedAccess && u >= n) {
       throw std::runtime_error("Vertex index is out of bounds.");
     }
   }
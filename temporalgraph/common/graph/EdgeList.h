@@ -4,10 +4,7 @@
 #include <unordered_map>
 
 #include "glog/logging.h"
-#include "lib/BitArray.h"
-#include "lib/utils/DeltaGapUtility.h"
-#include "lib/utils/HuffmanUtility.h"
-#include "lib/utils/Utils.h"
+#include "lib/HuffmanArray.h"
 #include "temporalgraph/common/graph/GraphUtils.h"
 
 namespace compact {
@@ -37,19 +34,30 @@ class EdgeList {
 
     build_intervals(events);
     // LOG(INFO) << "intervals built. size = " << intervals.size();
-    build_labels(events);
+    VertexContainer labels_array;
+    build_labels(events, labels_array);
     // LOG(INFO) << "labels built. labels = " << labels.to_string();
-    build_offsets(events, retrieve(labels, labels_huff, labels_dgap));
+    build_offsets(events, labels_array);
     // LOG(INFO) << "offsets built";
   }
 
+  /*
+    Binary search the label and decode only the intervals of that neighbour
+  */
   bool check_edge(uint v, int start, int end) const {
     if (!sz) return false;
-    auto labels = retrieve(this->labels, labels_huff, labels_dgap);
-    auto intervals = retrieve(this->intervals, intervals_huff, intervals_dgap);
-    auto offsets = retrieve(this->offsets, offsets_huff, offsets_dgap);
+    uint v_index = labels.lower_bound(v);
+    if (v_index == labels.size() || labels[v_index] != v) return false;
 
-    return check_edge(v, start, end, labels, intervals, offsets);
+    Container run;
+    get_intervals(v_index, run);
+    TimeInterval t{start, end};
+    for (uint i = 0; i + 1 < run.size(); i += 2) {
+      if (GraphUtils::intersects(t, {run[i], run[i + 1]})) {
+        return true;
+      }
+    }
+    return false;
   }
 
   /*
@@ -60,13 +68,22 @@ class EdgeList {
     if (!sz) return VertexContainer();
     // LOG(INFO) << "EdgeList get_neighbours";
     VertexContainer neighbours;
-    auto labels = retrieve(this->labels, labels_huff, labels_dgap);
-    auto intervals = retrieve(this->intervals, intervals_huff, intervals_dgap);
-    auto offsets = retrieve(this->offsets, offsets_huff, offsets_dgap);
-    // LOG(INFO) << "EdgeList get_labels: labels_retrieved";
-    for (uint i = 0; i < labels.size(); i++) {
-      if (check_edge(labels[i], start, end, labels, intervals, offsets)) {
-        neighbours.push_back(labels[i]);
+    TimeInterval t{start, end};
+    // labels and offsets go in lockstep, intervals are skipped up to the
+    // next offset once a neighbour is found active
+    auto offset = offsets.begin(), offsets_end = offsets.end();
+    auto interval = intervals.begin();
+    for (uint label : labels) {
+      uint r_offset = ++offset != offsets_end ? *offset : intervals.size();
+      bool active = false;
+      while (interval.index() + 1 < r_offset) {
+        uint interval_start = *interval++;
+        uint interval_end = *interval++;
+        if (!active &&
+            GraphUtils::intersects(t, {interval_start, interval_end})) {
+          neighbours.push_back(label);
+          active = true;
+        }
       }
     }
     return neighbours;
@@ -76,19 +93,18 @@ class EdgeList {
 
   std::string to_string() const {
     if (!sz) return "";
-    auto labels = retrieve(this->labels, labels_huff, labels_dgap);
-    auto intervals = retrieve(this->intervals, intervals_huff, intervals_dgap);
-    auto offsets = retrieve(this->offsets, offsets_huff, offsets_dgap);
-
     std::string line("");
-    for (uint i = 0; i < labels.size(); i++) {
-      for (uint j = offsets[i]; j < intervals.size(); j += 2) {
-        if (i + 1 < labels.size() && j >= offsets[i + 1]) break;
-
+    auto offset = offsets.begin(), offsets_end = offsets.end();
+    auto interval = intervals.begin();
+    for (uint label : labels) {
+      uint r_offset = ++offset != offsets_end ? *offset : intervals.size();
+      while (interval.index() + 1 < r_offset) {
+        uint interval_start = *interval++;
+        uint interval_end = *interval++;
         if (line.size() != 0) line += ", ";
         line += "{";
-        line += GraphUtils::to_string(labels[i]) + ",";
-        line += GraphUtils::to_string({intervals[j], intervals[j + 1]}) + "}";
+        line += GraphUtils::to_string(label) + ",";
+        line += GraphUtils::to_string({interval_start, interval_end}) + "}";
       }
     }
 
@@ -97,54 +113,20 @@ class EdgeList {
 
   uint measure_memory() const {
     return sizeof(sz) + labels.measure_memory() + intervals.measure_memory() +
-           offsets.measure_memory() + labels_dgap.measure_memory() +
-           intervals_dgap.measure_memory() + offsets_dgap.measure_memory() +
-           labels_huff.measure_memory() + intervals_huff.measure_memory() +
-           offsets_huff.measure_memory();
+           offsets.measure_memory();
   }
 
  private:
   uint sz;
-  lib::BitArray labels, intervals, offsets;
-  lib::DeltaGapUtility labels_dgap, intervals_dgap, offsets_dgap;
-  lib::HuffmanUtility labels_huff, intervals_huff, offsets_huff;
-
-  bool check_edge(uint v, int start, int end, Container& labels,
-                  Container& intervals, Container& offsets) const {
-    uint v_index = get_label_index(v, labels);
-    if (v_index == labels.size()) return false;
-
-    uint l_offset = offsets[v_index];
-    uint r_offset = (v_index + 1) < offsets.size() ? offsets[v_index + 1] - 1
-                                                   : (int)intervals.size() - 1;
-
-    TimeInterval t{start, end};
-    for (uint i = l_offset; i < r_offset; i += 2) {
-      if (GraphUtils::intersects(t, {intervals[i], intervals[i + 1]})) {
-        return true;
-      }
-    }
-    return false;
-  }
-
-  Container retrieve(const lib::BitArray& bit_stream,
-                     const lib::HuffmanUtility& huff,
-                     const lib::DeltaGapUtility& dgap) const {
-    Container tmp;
-    // LOG(INFO) << "enter retrieve. bit_stream size = " << bit_stream.size();
-    huff.decode(bit_stream, tmp);
-    // LOG(INFO) << "decoded bit_stream. tmp size = " << tmp.size();
-    auto ans = dgap.decode_array(tmp);
-    // LOG(INFO) << "dgap decoded";
-    return ans;
-  }
-
-  static uint get_label_index(uint label, const std::vector<uint>& labels) {
-    auto idx = lib::Utils::lower_bound(labels, 0, labels.size(), label);
-    if (idx == labels.size() || labels[idx] != label) {
-      return labels.size();
-    }
-    return idx;
+  // deltaGap + huffman encoded, with sampled random access
+  lib::HuffmanArray labels, intervals, offsets;
+
+  // decode the intervals of the neighbour on position v_index of labels
+  void get_intervals(uint v_index, Container& run) const {
+    Container bounds;
+    offsets.decode_range(v_index, v_index + 2, bounds);
+    uint r_offset = bounds.size() > 1 ? bounds[1] : intervals.size();
+    intervals.decode_range(bounds[0], r_offset, run);
   }
 
   /*
@@ -154,18 +136,17 @@ class EdgeList {
   void build_intervals(const TemporalNeighbourContainer& sorted_events) {
     std::vector<uint> interval_array;
     get_intervals_from_events(sorted_events, interval_array);
-    intervals_huff.encode(intervals_dgap.get_array_code(interval_array),
-                          intervals);
+    intervals.reset(interval_array);
   }
   /*
     Receive a sorted array of pairs {vertex, {start_t, end_t}} and builds the
     array with the offsets of the linked lists for each neighbour
   */
-  void build_labels(const TemporalNeighbourContainer& sorted_events) {
-    VertexContainer labels_array;
+  void build_labels(const TemporalNeighbourContainer& sorted_events,
+                    VertexContainer& labels_array) {
     get_labels_from_events(sorted_events, labels_array);
     // LOG(INFO) << "build_labels. labels_array size: " << labels_array.size();
-    labels_huff.encode(labels_dgap.get_array_code(labels_array), labels);
+    labels.reset(labels_array);
   }
 
   /*
@@ -179,7 +160,7 @@ class EdgeList {
     // LOG(INFO) << "build_offsets";
     get_offsets_from_events(sorted_events, labels, offsets_array);
     // LOG(INFO) << "got offsets from events";
-    offsets_huff.encode(offsets_dgap.get_array_code(offsets_array), offsets);
+    offsets.reset(offsets_array);
     // LOG(INFO) << "finished encoding";
   }
 
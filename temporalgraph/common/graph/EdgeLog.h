@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <memory>
 
 #include "glog/logging.h"
 #include "lib/VariableSizeDenseArray.h"
@@ -23,7 +24,7 @@ class EdgeLog : public AbstractGraph {
 
   EdgeLog(uint n) {
     this->n = n;
-    adj = new EdgeList[n]();
+    adj = std::make_unique<EdgeList[]>(n);
   }
 
   // returns whether there is an edge (u, v) active during that time interval
@@ -39,12 +40,21 @@ class EdgeLog : public AbstractGraph {
     return adj[u].get_neighbours(start, end);
   }
 
+  // answered from the reverse index when built, see reset_reverse_index
+  VertexContainer reverse_neighbours(Vertex v, uint start,
+                                     uint end) const override {
+    check_vertex(v);
+    if (!reverse_adj) return AbstractGraph::reverse_neighbours(v, start, end);
+    return reverse_adj[v].get_neighbours(start, end);
+  }
+
   std::string get_name() const override { return "EdgeLog"; }
 
   uint measure_memory() const override {
     uint sum = 0;
     for (uint i = 0; i < n; i++) {
       sum += adj[i].measure_memory();
+      if (reverse_adj) sum += reverse_adj[i].measure_memory();
     }
     return sum;
   }
@@ -54,6 +64,21 @@ class EdgeLog : public AbstractGraph {
     adj[u].set_events(events);
   }
 
+  /*
+    Drop the reverse index and, if enabled, allocate an empty one to be
+    filled with set_reverse_events. The reverse index stores the transposed
+    graph the same way as the graph itself, so reverse queries cost as much
+    as neighbours at the price of twice the memory.
+  */
+  void reset_reverse_index(bool enabled) {
+    reverse_adj = enabled ? std::make_unique<EdgeList[]>(n) : nullptr;
+  }
+
+  // events of vertex v on the transposed graph, each one {u, {start_t, end_t}}
+  void set_reverse_events(Vertex v, TemporalNeighbourContainer& events) {
+    reverse_adj[v].set_events(events);
+  }
+
   std::string to_string() const {
     std::string line = "\nEdgeLog\n";
     line += "n = ";
@@ -65,10 +90,12 @@ class EdgeLog : public AbstractGraph {
   }
 
  private:
-  EdgeList* adj;
+  std::unique_ptr<EdgeList[]> adj;
+  // lists of the transposed graph, NULL if there is no reverse index
+  std::unique_ptr<EdgeList[]> reverse_adj;
 
   void check_vertex(Vertex u) const {
-    if (u >= n) {
+    if (lib::kCheckedAccess && u >= n) {
       throw std::runtime_error("Vertex index is out of bounds.");
     }
   }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <memory>
 
 #include "glog/logging.h"
 #include "lib/VariableSizeDenseArray.h"
@@ -18,11 +19,20 @@ class EveLog : public AbstractGraph {
 
  public:
   using EventContainer = EventList;
+  using LabelMode = EventList::LabelMode;
   EveLog() {}
 
-  EveLog(uint n) {
+  /*
+    label_mode chooses how each vertex stores its neighbours labels, see
+    EventList::LabelMode. With dense labels, checkpoint_rate > 0 stores the
+    active neighbours every checkpoint_rate events of a vertex, trading memory
+    for shorter replays on queries.
+  */
+  EveLog(uint n, LabelMode label_mode = EventList::kDenseLabels,
+         uint checkpoint_rate = 0)
+      : label_mode(label_mode), checkpoint_rate(checkpoint_rate) {
     this->n = n;
-    adj = new EventList[n]();
+    adj = std::make_unique<EventList[]>(n);
   }
 
   // returns whether there is an edge (u, v) active during that time interval
@@ -38,12 +48,29 @@ class EveLog : public AbstractGraph {
     return adj[u].get_neighbours(start, end);
   }
 
+  // answered from the reverse index when built, see reset_reverse_index
+  VertexContainer reverse_neighbours(uint v, uint start,
+                                     uint end) const override {
+    check_vertex(v);
+    if (!reverse_adj) return AbstractGraph::reverse_neighbours(v, start, end);
+    VertexContainer answer = reverse_adj[v].get_neighbours(start, end);
+    std::sort(answer.begin(), answer.end());
+    return answer;
+  }
+
+  uint in_degree(uint v, uint start, uint end) const override {
+    check_vertex(v);
+    if (!reverse_adj) return AbstractGraph::in_degree(v, start, end);
+    return reverse_adj[v].get_neighbours(start, end).size();
+  }
+
   std::string get_name() const override { return "EveLog"; }
 
   uint measure_memory() const override {
-    uint sum = 0;
+    uint sum = sizeof(label_mode) + sizeof(checkpoint_rate);
     for (uint i = 0; i < n; i++) {
       sum += adj[i].measure_memory();
+      if (reverse_adj) sum += reverse_adj[i].measure_memory();
     }
     return sum;
   }
@@ -51,7 +78,21 @@ class EveLog : public AbstractGraph {
   // consider each edge being a pair {v, t}, where v is the vertex number, and t
   // is the time of the event
   void set_events(uint u, EdgeContainer& events) {
-    adj[u].set_events(events, n);
+    adj[u].set_events(events, n, label_mode, checkpoint_rate);
+  }
+
+  /*
+    Drop the reverse index and, if enabled, allocate an empty one to be
+    filled with set_reverse_events. It holds the event lists of the
+    transposed graph, with the same label mode and checkpoints as the graph.
+  */
+  void reset_reverse_index(bool enabled) {
+    reverse_adj = enabled ? std::make_unique<EventList[]>(n) : nullptr;
+  }
+
+  // events of vertex v on the transposed graph, each one a pair {u, t}
+  void set_reverse_events(uint v, EdgeContainer& events) {
+    reverse_adj[v].set_events(events, n, label_mode, checkpoint_rate);
   }
 
   std::string to_string() const {
@@ -65,10 +106,14 @@ class EveLog : public AbstractGraph {
   }
 
  private:
-  EventList* adj;
+  std::unique_ptr<EventList[]> adj;
+  // event lists of the transposed graph, NULL if there is no reverse index
+  std::unique_ptr<EventList[]> reverse_adj;
+  LabelMode label_mode;
+  uint checkpoint_rate;
 
   void check_vertex(uint u) const {
-    if (u >= n) {
+    if (lib::kCheckedAccess && u >= n) {
       throw std::runtime_error("Vertex index is out of bounds.");
     }
   }
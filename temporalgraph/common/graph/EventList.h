@@ -2,11 +2,13 @@
 
 #include <algorithm>
 #include <unordered_set>
+#include <vector>
 
 #include "glog/logging.h"
-#include "lib/BitArray.h"
+#include "lib/EliasFano.h"
+#include "lib/FixedSizeArray.h"
 #include "lib/VariableSizeDenseArray.h"
-#include "lib/utils/DeltaGapUtility.h"
+#include "lib/WaveletMatrix.h"
 #include "lib/utils/Utils.h"
 #include "temporalgraph/common/graph/GraphUtils.h"
 
@@ -21,13 +23,29 @@ class EventList {
   using Array = lib::VariableSizeDenseArray;
 
  public:
-  EventList() { sz = 0; }
+  /*
+    How the labels are stored: a dense array, smaller but counting a label is
+    linear, or a wavelet matrix, where counting a label is a rank
+  */
+  enum LabelMode { kDenseLabels, kWaveletLabels };
+
+  EventList() : sz(0), n(0), label_mode(kDenseLabels), checkpoint_rate(0) {}
+
+  /*
+    consider each edge being a pair {v, t}, where v is the vertex number, and t
+    is the time of the event
 
-  // consider each edge being a pair {v, t}, where v is the vertex number, and t
-  // is the time of the event
-  void set_events(EdgeContainer& events, uint n) {
+    With dense labels and checkpoint_rate > 0, the set of active neighbours is
+    stored every checkpoint_rate events, so queries replay the events from the
+    closest checkpoint instead of from the first event.
+  */
+  void set_events(EdgeContainer& events, uint n,
+                  LabelMode label_mode = kDenseLabels,
+                  uint checkpoint_rate = 0) {
     sz = events.size();
     this->n = n;
+    this->label_mode = label_mode;
+    this->checkpoint_rate = label_mode == kDenseLabels ? checkpoint_rate : 0;
 
     // LOG(INFO) << "EventList set_events. events size: " << events.size();
     // order events by time in ascending order
@@ -38,24 +56,26 @@ class EventList {
     // LOG(INFO) << "labels set. labels size: " << labels.size();
     set_timestamps(events);
     // LOG(INFO) << "timestamps set. timestamps size: " << timestamps.size();
+    set_checkpoints(events);
   }
 
   bool check_edge(uint v, int start, int end) const {
-    auto timestamps = get_timestamps();
-    // LOG(INFO) << "timestamps:";
-    // for (auto t : timestamps) {
-    //   LOG(INFO) << t;
-    // }
     if (timestamps.size() == 0) return false;
-    uint tbegin = lib::Utils::lower_bound(timestamps, 0,
-                                          (int)timestamps.size() - 1, start);
-    uint tend =
-        lib::Utils::upper_bound(timestamps, 0, (int)timestamps.size() - 1, end);
-    uint fbegin = count_label(v, tbegin);
-    uint fend = count_label(v, tend);
-    // LOG(INFO) << "tbegin: " << tbegin << ", tend: " << tend
-    //           << ", fbegin: " << fbegin << ", fend: " << fend;
-    return (fbegin % 2) || fend > fbegin;
+    uint tbegin = timestamps.next_geq(start);
+    uint tend = timestamps.next_gt(end);
+    if (label_mode == kWaveletLabels) {
+      uint fbegin = count_label(v, tbegin);
+      uint fend = count_label(v, tend);
+      return (fbegin % 2) || fend > fbegin;
+    }
+
+    // active at the beginning of the interval, or appearing inside of it
+    uint c = get_checkpoint(tbegin);
+    bool active = checkpoint_contains(c, v);
+    auto label = labels.cursor(c * checkpoint_rate);
+    for (; label.index() < tbegin; ++label) active ^= *label == v;
+    for (; !active && label.index() < tend; ++label) active = *label == v;
+    return active;
   }
 
   /*
@@ -66,49 +86,37 @@ class EventList {
     if (sz == 0) return VertexContainer();
 
     // LOG(INFO) << "EventList get_neighbours. size = " << sz;
-    auto timestamps = get_timestamps();
-    // LOG(INFO) << "EventList get_neighbours got timestamps. size = "
-    //           << timestamps.size();
-
-    std::unordered_set<uint> activeElements, chosen;
-
-    // check which elements were active before the interval start
-    uint i;
-    for (i = 0; i < sz; i++) {
-      uint t = timestamps[i];
-      uint vtx = labels[i];
-      if (t >= start) {
-        break;
-      }
+    // the query window is [tbegin, tend)
+    uint tbegin = timestamps.next_geq(start);
+    uint tend = timestamps.next_gt(end);
+
+    VertexContainer neighbours;
+    if (label_mode == kWaveletLabels) {
+      label_wavelet.range_active_values(0, tbegin, tend, n - 1, neighbours);
+      return neighbours;
+    }
+
+    // elements active before the interval start, from the closest checkpoint
+    std::unordered_set<uint> activeElements;
+    uint c = get_checkpoint(tbegin);
+    load_checkpoint(c, activeElements);
+    auto label = labels.cursor(c * checkpoint_rate);
+    for (; label.index() < tbegin; ++label) {
+      uint vtx = *label;
       if (activeElements.count(vtx)) {
         activeElements.erase(vtx);
       } else {
         activeElements.insert(vtx);
       }
     }
-
-    // add the active elements to the answer
-    VertexContainer neighbours;
-    for (uint j = 0; j < sz; j++) {
-      uint t = timestamps[j];
-      uint vtx = labels[j];
-      if (t >= start) break;
-      if (activeElements.count(vtx) && !chosen.count(vtx)) {
-        neighbours.push_back(vtx);
-        chosen.insert(vtx);
-      }
-    }
+    neighbours.assign(activeElements.begin(), activeElements.end());
 
     // add the vertices that became active inside the interval
-    for (i = 0; i < sz; i++) {
-      uint t = timestamps[i];
-      uint vtx = labels[i];
-      if (t < start) continue;
-      if (t > end) break;
-
-      if (!activeElements.count(vtx) && !chosen.count(vtx)) {
+    for (; label.index() < tend; ++label) {
+      uint vtx = *label;
+      if (!activeElements.count(vtx)) {
         neighbours.push_back(vtx);
-        chosen.insert(vtx);
+        activeElements.insert(vtx);
       }
     }
 
@@ -118,32 +126,57 @@ class EventList {
   uint size() const { return sz; }
 
   std::string to_string() const {
+    std::vector<uint> times;
+    timestamps.decode_range(0, sz, times);
     std::string line = "[";
+    auto label = labels.begin();
     for (uint i = 0; i < sz; i++) {
       if (i) line += ", ";
-      line += GraphUtils::to_string(Edge(labels[i], timestamps[i]));
+      uint vtx = label_mode == kDenseLabels ? *label++ : label_wavelet[i];
+      line += GraphUtils::to_string(Edge(vtx, times[i]));
     }
     line += "]";
     return line;
   }
 
   uint measure_memory() const {
-    return sizeof(sz) + sizeof(n) + labels.measure_memory() +
-           timestamps.measure_memory() + deltaGapUtils.measure_memory();
+    return sizeof(sz) + sizeof(n) + sizeof(label_mode) +
+           sizeof(checkpoint_rate) + labels.measure_memory() +
+           label_wavelet.measure_memory() + timestamps.measure_memory() +
+           checkpoint_offsets.measure_memory() +
+           checkpoint_labels.measure_memory();
   }
 
  private:
   uint sz;
   uint n;
-  Array labels, timestamps;
-  lib::DeltaGapUtility deltaGapUtils;
+  LabelMode label_mode;
+  // only one of them is filled, according to label_mode
+  Array labels;
+  lib::WaveletMatrix label_wavelet;
+  lib::EliasFanoArray timestamps;
+  // events between two checkpoints, 0 if there are none
+  uint checkpoint_rate;
+  /*
+    checkpoint c holds the sorted active labels before event
+    c * checkpoint_rate, on checkpoint_labels[offsets[c], offsets[c + 1])
+    (the last offset is only an end marker)
+  */
+  lib::EliasFanoArray checkpoint_offsets;
+  lib::FixedSizeArray checkpoint_labels;
 
   void set_labels(EdgeContainer& events) {
     std::vector<uint> values;
     for (uint i = 0; i < sz; i++) {
       values.push_back(events[i].first);
     }
-    labels.reset(values);
+    if (label_mode == kWaveletLabels) {
+      labels.reset(std::vector<uint>());
+      label_wavelet.reset(std::move(values));
+    } else {
+      label_wavelet.reset(std::vector<uint>());
+      labels.reset(values);
+    }
   }
 
   void set_timestamps(EdgeContainer& events) {
@@ -151,17 +184,67 @@ class EventList {
     for (uint i = 0; i < sz; i++) {
       values.push_back(events[i].second);
     }
-    timestamps.reset(deltaGapUtils.get_array_code(values));
+    timestamps.reset(values);
+  }
+
+  void set_checkpoints(const EdgeContainer& events) {
+    std::vector<uint> offsets, active_labels;
+    if (checkpoint_rate) {
+      std::unordered_set<uint> active;
+      // checkpoint 0 is the empty set before the first event
+      offsets.push_back(0);
+      for (uint i = 0; i < sz; i++) {
+        if (i && !(i % checkpoint_rate)) {
+          offsets.push_back(active_labels.size());
+          std::vector<uint> snapshot(active.begin(), active.end());
+          std::sort(snapshot.begin(), snapshot.end());
+          active_labels.insert(active_labels.end(), snapshot.begin(),
+                               snapshot.end());
+        }
+        uint vtx = events[i].first;
+        if (!active.erase(vtx)) active.insert(vtx);
+      }
+      offsets.push_back(active_labels.size());
+    }
+    uint max_label = active_labels.empty()
+                         ? 0
+                         : *std::max_element(active_labels.begin(),
+                                             active_labels.end());
+    checkpoint_offsets.reset(offsets);
+    checkpoint_labels.reset(active_labels,
+                            1 + lib::BitmaskUtility::int_log(max_label));
+  }
+
+  // closest checkpoint at or before the given event index
+  uint get_checkpoint(uint index) const {
+    if (!checkpoint_rate) return 0;
+    return std::min(index / checkpoint_rate, checkpoint_offsets.size() - 2);
+  }
+
+  void load_checkpoint(uint c, std::unordered_set<uint>& active) const {
+    active.clear();
+    if (!checkpoint_rate) return;
+    uint end = checkpoint_offsets[c + 1];
+    for (uint i = checkpoint_offsets[c]; i < end; i++) {
+      active.insert(checkpoint_labels[i]);
+    }
   }
 
-  lib::DeltaGapUtility::Container get_timestamps() const {
-    return deltaGapUtils.decode_array(timestamps);
+  bool checkpoint_contains(uint c, uint label) const {
+    if (!checkpoint_rate) return false;
+    uint begin = checkpoint_offsets[c], end = checkpoint_offsets[c + 1];
+    if (begin == end) return false;
+    uint idx =
+        lib::Utils::lower_bound(checkpoint_labels, begin, end - 1, label);
+    return idx < end && checkpoint_labels[idx] == label;
   }
 
+  // number of occurrences of label on [0, index)
   uint count_label(uint label, uint index) const {
+    if (label_mode == kWaveletLabels) return label_wavelet.rank(index, label);
     uint count = 0;
-    for (uint i = 0; i < index; i++) {
-      count += labels[i] == label;
+    for (auto it = labels.begin(); it.index() < index; ++it) {
+      count += *it == label;
     }
     return count;
   }
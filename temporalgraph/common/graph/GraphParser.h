@@ -1,6 +1,7 @@
 #pragma once
 
 #include "glog/logging.h"
+#include "lib/utils/Utils.h"
 #include "temporalgraph/common/graph/CAS.h"
 #include "temporalgraph/common/graph/EdgeLog.h"
 #include "temporalgraph/common/graph/EveLog.h"
@@ -65,19 +66,42 @@ class GraphParser {
     }
   }
 
-  static void fillEdgeLog(TemporalAdjacencyList& adj, EdgeLog& g) {
-    for (uint u = 0; u < adj.size(); u++) {
-      // LOG(INFO) << "set events for vertex " << u;
-      g.set_events(u, adj[u]);
-    }
+  /*
+    The vertices are built independently, on up to the given number of
+    threads. They are handed out in chunks of kBuildChunkSize, so threads
+    finishing early take over the remaining chunks and a few high degree
+    vertices do not hold back the rest of the build. With reverse_index, the
+    transposed graph is built too, answering reverse_neighbours.
+  */
+  static void fillEdgeLog(TemporalAdjacencyList& adj, EdgeLog& g,
+                          uint threads = 1, bool reverse_index = false) {
+    lib::Utils::parallel_for_chunks(
+        adj.size(), threads, kBuildChunkSize, [&](uint begin, uint end) {
+          for (uint u = begin; u < end; u++) g.set_events(u, adj[u]);
+        });
+    g.reset_reverse_index(reverse_index);
+    if (!reverse_index) return;
+    TemporalAdjacencyList transposed = GraphUtils::transpose(adj);
+    lib::Utils::parallel_for_chunks(
+        transposed.size(), threads, kBuildChunkSize,
+        [&](uint begin, uint end) {
+          for (uint v = begin; v < end; v++) {
+            g.set_reverse_events(v, transposed[v]);
+          }
+        });
   }
 
-  static void fillEveLog(TemporalAdjacencyList& adj, EveLog& g) {
-    GraphUtils::EdgeContainer events;
-    for (uint u = 0; u < adj.size(); u++) {
-      createEvelogEvents(adj[u], events);
-      g.set_events(u, events);
-    }
+  static void fillEveLog(TemporalAdjacencyList& adj, EveLog& g,
+                         uint threads = 1, bool reverse_index = false) {
+    fillEveLogEvents(adj, threads, [&](uint u, GraphUtils::EdgeContainer& e) {
+      g.set_events(u, e);
+    });
+    g.reset_reverse_index(reverse_index);
+    if (!reverse_index) return;
+    fillEveLogEvents(GraphUtils::transpose(adj), threads,
+                     [&](uint v, GraphUtils::EdgeContainer& e) {
+                       g.set_reverse_events(v, e);
+                     });
   }
 
   static void fillCAS(const TemporalAdjacencyList& adj, CAS& g) {
@@ -85,6 +109,23 @@ class GraphParser {
   }
 
  private:
+  // vertices handed to a thread at a time on the parallel builds
+  static constexpr uint kBuildChunkSize = 256;
+
+  // call set(u, events) with the EveLog events of each vertex u of adj
+  template <typename Setter>
+  static void fillEveLogEvents(const TemporalAdjacencyList& adj, uint threads,
+                               const Setter& set) {
+    lib::Utils::parallel_for_chunks(
+        adj.size(), threads, kBuildChunkSize, [&](uint begin, uint end) {
+          GraphUtils::EdgeContainer events;
+          for (uint u = begin; u < end; u++) {
+            createEvelogEvents(adj[u], events);
+            set(u, events);
+          }
+        });
+  }
+
   static void createEvelogEvents(const TemporalNeighbourContainer& neighbours,
                                  GraphUtils::EdgeContainer& ans) {
     ans.clear();
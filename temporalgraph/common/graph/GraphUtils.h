@@ -3,6 +3,8 @@
 #include <utility>
 #include <vector>
 
+#include "lib/utils/AccessPolicy.h"
+
 namespace compact {
 namespace temporalgraph {
 
@@ -26,7 +28,8 @@ class GraphUtils {
     (endpoints included)
   */
   static bool intersects(const TimeInterval& i1, const TimeInterval& i2) {
-    if (i1.first > i1.second || i2.first > i2.second) {
+    if (lib::kCheckedAccess &&
+        (i1.first > i1.second || i2.first > i2.second)) {
       throw std::runtime_error("Invalid intervals! start > end");
     }
     if (i1.first <= i2.first) {
@@ -82,6 +85,25 @@ class GraphUtils {
     return ans;
   }
 
+  // vertices u with an edge (u, v) active on [tbegin, tend], increasingly
+  static VertexContainer reverse_neighbours(const TemporalAdjacencyList& adj,
+                                            uint v, uint tbegin, uint tend) {
+    VertexContainer ans;
+    for (uint u = 0; u < adj.size(); u++) {
+      if (has_edge(adj, u, v, tbegin, tend)) ans.push_back(u);
+    }
+    return ans;
+  }
+
+  // the graph with every temporal edge (u, v) turned into (v, u)
+  static TemporalAdjacencyList transpose(const TemporalAdjacencyList& adj) {
+    TemporalAdjacencyList transposed(adj.size());
+    for (uint u = 0; u < adj.size(); u++) {
+      for (auto& e : adj[u]) transposed[e.first].push_back({u, e.second});
+    }
+    return transposed;
+  }
+
   static std::string to_string(TemporalAdjacencyList adj) {
     std::string str = "{";
     for (uint i = 0; i < adj.size(); i++) {
@@ -44,6 +44,12 @@ TEST(AdjacencyListTest, adjacencyList_test) {
           tmp = graph.neighbours(j, t.first, t.second);
           std::sort(tmp.begin(), tmp.end());
           EXPECT_EQ(tmp, GraphUtils::neighbours(adj, j, t.first, t.second));
+
+          // test reverse_neighbours and in_degree
+          auto reverse =
+              GraphUtils::reverse_neighbours(adj, j, t.first, t.second);
+          EXPECT_EQ(graph.reverse_neighbours(j, t.first, t.second), reverse);
+          EXPECT_EQ(graph.in_degree(j, t.first, t.second), reverse.size());
         }
       }
     }
@@ -40,7 +40,7 @@ AbstractGraph::EdgeContainer aggregate(const CAS::TemporalAdjacencyList& adj,
                                        uint start, uint end) {
   AbstractGraph::EdgeContainer ans;
   for (uint u = 0; u < adj.size(); u++) {
-    auto neigh = neighbours(adj, u, start, end);
+    auto neigh = GraphUtils::neighbours(adj, u, start, end);
     for (uint v : neigh) ans.push_back(AbstractGraph::Edge(u, v));
   }
   return ans;
@@ -93,11 +93,113 @@ TEST(CASTest, CAS_test) {
           tmp = graph.neighbours(j, t.first, t.second);
           std::sort(tmp.begin(), tmp.end());
           EXPECT_EQ(tmp, GraphUtils::neighbours(adj, j, t.first, t.second));
+
+          // test reverse_neighbours and in_degree
+          auto reverse =
+              GraphUtils::reverse_neighbours(adj, j, t.first, t.second);
+          EXPECT_EQ(graph.reverse_neighbours(j, t.first, t.second), reverse);
+          EXPECT_EQ(graph.in_degree(j, t.first, t.second), reverse.size());
         }
       }
     }
     LOG(INFO) << graph.to_string();
     EXPECT_EQ(graph.get_name(), std::string("CAS"));
+
+    // building from an rvalue releases the input and yields the same graph
+    GraphUtils::TemporalAdjacencyList input(adj);
+    CAS moved_graph(std::move(input));
+    EXPECT_TRUE(input.empty());
+    EXPECT_EQ(moved_graph.to_string(), graph.to_string());
+  }
+}
+
+// test aggregate on several threads, ordered, unordered and streamed
+TEST(CASTest, parallelAggregateTest) {
+  uint V = 5000, E = 20000, T = 100, epochs = 5;
+  GraphUtils::TemporalAdjacencyList adj =
+      TestUtils::get_random_graph(V, E, T);
+  CAS graph(adj);
+  for (uint k = 0; k < epochs; k++) {
+    auto t = TestUtils::get_random_temporal_range(T + T / 2);
+    auto edges = graph.aggregate(t.first, t.second);
+    EXPECT_TRUE(equals(edges, aggregate(adj, t.first, t.second)));
+    // same edges, in the same order, as querying each vertex
+    AbstractGraph::EdgeContainer queried;
+    for (uint u = 0; u < V; u++) {
+      for (uint v : graph.neighbours(u, t.first, t.second)) {
+        queried.push_back(AbstractGraph::Edge(u, v));
+      }
+    }
+    EXPECT_EQ(edges, queried);
+    EXPECT_EQ(graph.aggregate(t.first, t.second, 4), edges);
+    EXPECT_TRUE(equals(graph.aggregate(t.first, t.second, 4, false), edges));
+
+    // batches cover disjoint vertex ranges, in order
+    AbstractGraph::EdgeContainer streamed;
+    uint batches = 0;
+    graph.aggregate(
+        t.first, t.second,
+        [&](AbstractGraph::EdgeContainer& batch) {
+          batches++;
+          if (!batch.empty() && !streamed.empty()) {
+            EXPECT_LT(streamed.back().first, batch.front().first);
+          }
+          streamed.insert(streamed.end(), batch.begin(), batch.end());
+        },
+        4);
+    EXPECT_EQ(streamed, edges);
+    EXPECT_GE(batches, 1u);
+    EXPECT_LE(batches, V);
+  }
+}
+
+// exposes the batched aggregate_range of CAS next to the per-vertex default
+class RangeCAS : public CAS {
+ public:
+  using CAS::CAS;
+
+  AbstractGraph::EdgeContainer batched(uint first, uint last, uint start,
+                                       uint end) const {
+    AbstractGraph::EdgeContainer edges;
+    aggregate_range(first, last, start, end, edges);
+    return edges;
+  }
+
+  AbstractGraph::EdgeContainer per_vertex(uint first, uint last, uint start,
+                                          uint end) const {
+    AbstractGraph::EdgeContainer edges;
+    AbstractGraph::aggregate_range(first, last, start, end, edges);
+    return edges;
+  }
+};
+
+// test aggregate_range on windows splitting most vertex ranges in the middle
+TEST(CASTest, aggregateRangeTest) {
+  uint V = 600, E = 30000, T = 1000;
+  GraphUtils::TemporalAdjacencyList adj =
+      TestUtils::get_random_graph(V, E, T);
+  RangeCAS graph(adj);
+  for (auto t : std::vector<std::pair<uint, uint>>{
+           {T / 3, 2 * T / 3}, {T / 2, T / 2}, {T / 4, T / 2}, {0, T}}) {
+    // vertices with events both before and after the window
+    uint split = 0;
+    for (uint u = 0; u < V; u++) {
+      bool before = false, after = false;
+      for (auto& e : adj[u]) {
+        before |= e.second.first < t.first;
+        after |= e.second.second > t.second;
+      }
+      split += before && after;
+    }
+    if (t.first && t.second < T) EXPECT_GT(split, 9 * V / 10);
+
+    EXPECT_EQ(graph.batched(0, V, t.first, t.second),
+              graph.per_vertex(0, V, t.first, t.second));
+    EXPECT_EQ(graph.batched(7, V - 5, t.first, t.second),
+              graph.per_vertex(7, V - 5, t.first, t.second));
+    EXPECT_EQ(graph.batched(V / 2, V / 2 + 1, t.first, t.second),
+              graph.per_vertex(V / 2, V / 2 + 1, t.first, t.second));
+    EXPECT_TRUE(graph.batched(V / 2, V / 2, t.first, t.second).empty());
   }
 }
 
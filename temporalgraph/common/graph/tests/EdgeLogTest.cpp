@@ -24,7 +24,8 @@ TEST(EdgeLogTest, edgeLog_test) {
     GraphUtils::TemporalAdjacencyList adj =
         TestUtils::get_random_graph(V, E, T);
     LOG(INFO) << "adj: " << GraphUtils::to_string(adj);
-    GraphParser::fillEdgeLog(adj, graph);
+    // every other graph answers the reverse queries from a reverse index
+    GraphParser::fillEdgeLog(adj, graph, 1, x % 2);
     // LOG(INFO) << graph.to_string();
 
     for (uint i = 0; i < V; i++) {
@@ -45,6 +46,12 @@ TEST(EdgeLogTest, edgeLog_test) {
           tmp = graph.neighbours(j, t.first, t.second);
           std::sort(tmp.begin(), tmp.end());
           EXPECT_EQ(tmp, GraphUtils::neighbours(adj, j, t.first, t.second));
+
+          // test reverse_neighbours and in_degree
+          auto reverse =
+              GraphUtils::reverse_neighbours(adj, j, t.first, t.second);
+          EXPECT_EQ(graph.reverse_neighbours(j, t.first, t.second), reverse);
+          EXPECT_EQ(graph.in_degree(j, t.first, t.second), reverse.size());
         }
       }
     }
@@ -97,6 +104,19 @@ TEST(EdgeLogTest, edgeLog_test) {
 //   LOG(INFO) << graph.to_string();
 // }
 
+// test building the vertices on several threads gives the same graph
+TEST(EdgeLogTest, parallelBuildTest) {
+  uint V = 2000, E = 10000, T = 100;
+  GraphUtils::TemporalAdjacencyList adj =
+      TestUtils::get_random_graph(V, E, T);
+  GraphUtils::TemporalAdjacencyList adj_copy(adj);
+  EdgeLog sequential(V), parallel(V);
+  GraphParser::fillEdgeLog(adj, sequential);
+  GraphParser::fillEdgeLog(adj_copy, parallel, 4);
+  EXPECT_EQ(parallel.to_string(), sequential.to_string());
+  EXPECT_EQ(parallel.measure_memory(), sequential.measure_memory());
+}
+
 }  // namespace test
 }  // namespace temporalgraph
 }  // namespace compact
\ No newline at end of file
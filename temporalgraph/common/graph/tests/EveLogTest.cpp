@@ -12,19 +12,19 @@ namespace compact {
 namespace temporalgraph {
 namespace test {
 
-// test expected functionalities of EveLog data structure
-TEST(EveLogTest, evelog_test) {
+void run_evelog_tests(EveLog::LabelMode label_mode, uint checkpoint_rate = 0) {
   /*
     init
   */
   LOG(INFO) << "EvelogTest init";
   uint V = 20, E = 100, T = 100, epochs = 10, graphs = 10;
-  EveLog graph(V);
+  EveLog graph(V, label_mode, checkpoint_rate);
   for (uint x = 0; x < graphs; x++) {
     GraphUtils::TemporalAdjacencyList adj =
         TestUtils::get_random_graph(V, E, T);
     LOG(INFO) << "adj: " << GraphUtils::to_string(adj);
-    GraphParser::fillEveLog(adj, graph);
+    // every other graph answers the reverse queries from a reverse index
+    GraphParser::fillEveLog(adj, graph, 1, x % 2);
     // LOG(INFO) << graph.to_string();
 
     for (uint i = 0; i < V; i++) {
@@ -45,6 +45,12 @@ TEST(EveLogTest, evelog_test) {
           tmp = graph.neighbours(j, t.first, t.second);
           std::sort(tmp.begin(), tmp.end());
           EXPECT_EQ(tmp, GraphUtils::neighbours(adj, j, t.first, t.second));
+
+          // test reverse_neighbours and in_degree
+          auto reverse =
+              GraphUtils::reverse_neighbours(adj, j, t.first, t.second);
+          EXPECT_EQ(graph.reverse_neighbours(j, t.first, t.second), reverse);
+          EXPECT_EQ(graph.in_degree(j, t.first, t.second), reverse.size());
         }
       }
     }
@@ -54,6 +60,32 @@ TEST(EveLogTest, evelog_test) {
   LOG(INFO) << graph.to_string();
 }
 
+// test expected functionalities of EveLog data structure
+TEST(EveLogTest, evelog_test) { run_evelog_tests(EventList::kDenseLabels); }
+
+// test EveLog with active set checkpoints, including one every event
+TEST(EveLogTest, evelogCheckpointsTest) {
+  run_evelog_tests(EventList::kDenseLabels, 1);
+  run_evelog_tests(EventList::kDenseLabels, 3);
+}
+
+// test EveLog storing the labels on wavelet matrices
+TEST(EveLogTest, evelogWaveletLabelsTest) {
+  run_evelog_tests(EventList::kWaveletLabels);
+}
+
+// test building the vertices on several threads gives the same graph
+TEST(EveLogTest, evelogParallelBuildTest) {
+  uint V = 2000, E = 10000, T = 100;
+  GraphUtils::TemporalAdjacencyList adj =
+      TestUtils::get_random_graph(V, E, T);
+  EveLog sequential(V), parallel(V);
+  GraphParser::fillEveLog(adj, sequential);
+  GraphParser::fillEveLog(adj, parallel, 4);
+  EXPECT_EQ(parallel.to_string(), sequential.to_string());
+  EXPECT_EQ(parallel.measure_memory(), sequential.measure_memory());
+}
+
 }  // namespace test
 }  // namespace temporalgraph
 }  // namespace compact
\ No newline at end of file
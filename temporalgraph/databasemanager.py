@@ -14,6 +14,7 @@ CREATE_TABLE_QUERY = '''
     aggregate_time_ms   FLOAT,
     graph_size_kb       INT,
     max_rss_kb          INT,
+    build_rss_kb        INT,
     has_edge_epochs     INT,
     neighbours_epochs   INT,
     aggregate_epochs    INT,
@@ -28,6 +29,12 @@ WHERE TABLE_NAME = N'experiments_data'
 ORDER BY ORDINAL_POSITION
 '''
 
+# tables created before build_rss_kb was tracked
+ADD_BUILD_RSS_COLUMN_QUERY = '''
+ALTER TABLE experiments_data
+ADD COLUMN build_rss_kb INT AFTER max_rss_kb
+'''
+
 SELECT_TABLE_QUERY = '''
 SELECT * FROM experiments_data
 '''
@@ -48,6 +55,7 @@ def get_insert_query(values):
       {values["aggregate_time_ms"]},
       {values["graph_size_kb"]},
       {values["max_rss_kb"]},
+      {values["build_rss_kb"]},
       {values["has_edge_epochs"]},
       {values["neighbours_epochs"]},
       {values["aggregate_epochs"]}
@@ -82,6 +90,10 @@ class DatabaseManager:
         self.cursor.execute("SHOW DATABASES")
         print(f'databases:\n{self.cursor.fetchall()}')
         self.cursor.execute(CREATE_TABLE_QUERY)
+        self.cursor.execute(GET_TABLE_COLUMNS_QUERY)
+        columns = [c[0] for c in self.cursor.fetchall()]
+        if "build_rss_kb" not in columns:
+            self.cursor.execute(ADD_BUILD_RSS_COLUMN_QUERY)
         self.cursor.execute("SHOW TABLES")
         print(f'tables:\n{self.cursor.fetchall()}')
 
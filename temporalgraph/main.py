@@ -37,7 +37,7 @@ def update_with_flags(commandline, config, output_file):
 
 def run_version(config, version, database):
     subprocess.run(
-        ["bazel", "build", f"v{version}:main"])
+        ["bazel", "build", "--config=release", f"v{version}:main"])
     print(config.datapath)
     output_file = f"v{version}/{OUTPUT_FILENAME}"
     pmonitor = ProcessMonitor(
@@ -28,13 +28,14 @@ int main(int argc, char *argv[]) {
   TimeCounter build_time_counter;
   build_time_counter.start();
   EdgeLog g(V);
-  GraphParser::fillEdgeLog(adj, g);
+  GraphParser::fillEdgeLog(adj, g, FLAGS_build_threads);
   build_time_counter.stop();
+  rss.measure("after_build");
 
   TestSummary summary =
       (new TestRunner())
           ->run(g, V, E, T, FLAGS_has_edge_epochs, FLAGS_neighbours_epochs,
-                FLAGS_aggregate_epochs);
+                FLAGS_aggregate_epochs, FLAGS_aggregate_threads);
 
   rss.measure("after_tests");
 
@@ -44,6 +45,7 @@ int main(int argc, char *argv[]) {
                                rss.get_discounted("after_tests"),
                                FLAGS_has_edge_epochs, FLAGS_neighbours_epochs,
                                FLAGS_aggregate_epochs);
+  summary.set_build_rss_kb(rss.get_discounted("after_build"));
 
   // write results to file
   std::ofstream f;
@@ -28,16 +28,20 @@ int main(int argc, char *argv[]) {
 
   TimeCounter build_time_counter;
   build_time_counter.start();
-  EveLog g(V);
+  EveLog g(V,
+           FLAGS_wavelet_labels ? EventList::kWaveletLabels
+                                : EventList::kDenseLabels,
+           FLAGS_checkpoint_rate);
   // LOG(INFO) << "built evelog";
-  GraphParser::fillEveLog(adj, g);
+  GraphParser::fillEveLog(adj, g, FLAGS_build_threads);
   // LOG(INFO) << "filled evelog";
   build_time_counter.stop();
+  rss.measure("after_build");
 
   TestSummary summary =
       (new TestRunner())
           ->run(g, V, E, T, FLAGS_has_edge_epochs, FLAGS_neighbours_epochs,
-                FLAGS_aggregate_epochs);
+                FLAGS_aggregate_epochs, FLAGS_aggregate_threads);
 
   rss.measure("after_tests");
 
@@ -47,6 +51,7 @@ int main(int argc, char *argv[]) {
                                rss.get_discounted("after_tests"),
                                FLAGS_has_edge_epochs, FLAGS_neighbours_epochs,
                                FLAGS_aggregate_epochs);
+  summary.set_build_rss_kb(rss.get_discounted("after_build"));
   // write results to file
   std::ofstream f;
   f.open(FLAGS_output_file);
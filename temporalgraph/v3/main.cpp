@@ -29,11 +29,12 @@ int main(int argc, char *argv[]) {
   build_time_counter.start();
   AdjacencyList g(adj);
   build_time_counter.stop();
+  rss.measure("after_build");
 
   TestSummary summary =
       (new TestRunner())
           ->run(g, V, E, T, FLAGS_has_edge_epochs, FLAGS_neighbours_epochs,
-                FLAGS_aggregate_epochs);
+                FLAGS_aggregate_epochs, FLAGS_aggregate_threads);
 
   rss.measure("after_tests");
 
@@ -43,6 +44,7 @@ int main(int argc, char *argv[]) {
                                rss.get_discounted("after_tests"),
                                FLAGS_has_edge_epochs, FLAGS_neighbours_epochs,
                                FLAGS_aggregate_epochs);
+  summary.set_build_rss_kb(rss.get_discounted("after_build"));
 
   // write results to file
   std::ofstream f;